@@ -702,6 +702,14 @@ const std::unordered_set<signal_id_t> Circuit::get_prev_regs(const signal_id_t s
     return empty;
 }
 
+const std::unordered_set<const Cell*>& Circuit::get_fanout(const signal_id_t sig) const
+{
+    static const std::unordered_set<const Cell*> empty;
+    const auto& f = d_fanout_cells.find(sig);
+    if (f != d_fanout_cells.end()) return f->second;
+    return empty;
+}
+
 const std::unordered_set<signal_id_t>* Circuit::get_conn_regs(const signal_id_t sig) const
 {
     assert(!d_connected_regs.empty());
@@ -731,6 +739,9 @@ std::stringstream Circuit::stats() const
 
 void Circuit::build_adjacent_lists()
 {
+    // Built once, as a design may be shared by several checks
+    if (!d_connected_outs.empty()) return;
+
     // Graph traveral to find adjacent vertices
     // First, we build a map between a wire and its adjacent cells
     std::unordered_map<signal_id_t, std::unordered_set<const Cell*>> sig_to_cells;
@@ -870,4 +881,7 @@ void Circuit::build_adjacent_lists()
             d_previous_regs[conn_reg].emplace(sig);
         }
     }
+
+    // Keep the cells reading each signal for fanout queries
+    d_fanout_cells = std::move(sig_to_cells);
 }
@@ -47,6 +47,7 @@ protected:
     std::unordered_map<signal_id_t, std::unordered_set<signal_id_t>*> d_connected_regs;
     std::unordered_map<signal_id_t, std::unordered_set<signal_id_t>*> d_connected_outs;
     std::unordered_map<signal_id_t, std::unordered_set<signal_id_t>> d_previous_regs;
+    std::unordered_map<signal_id_t, std::unordered_set<const Cell*>> d_fanout_cells;
     std::unordered_map<signal_id_t, VerilogId> m_bit_name;
     std::string m_module_name;
     signal_id_t m_sig_clock;
@@ -66,6 +67,7 @@ public:
     const std::unordered_set<signal_id_t>* get_conn_regs(const signal_id_t sig) const;
     const std::unordered_set<signal_id_t>* get_conn_outs(const signal_id_t sig) const;
     const std::unordered_set<signal_id_t> get_prev_regs(const signal_id_t sig) const;
+    const std::unordered_set<const Cell*>& get_fanout(const signal_id_t sig) const;
     VerilogId bit_name(const signal_id_t sig) const { return m_bit_name.at(sig); }
     const std::vector<signal_id_t>& operator[](const std::string& name) const;
     std::stringstream stats() const;
@@ -0,0 +1,208 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "Simulator.h"
+
+const uint64_t TT_VAR[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+bool is_constant(signal_id_t sig)
+{
+    return sig == signal_id_t::S_0 || sig == signal_id_t::S_1 ||
+           sig == signal_id_t::S_X || sig == signal_id_t::S_Z;
+}
+
+std::vector<signal_id_t> cell_inputs(const Cell* cell)
+{
+    const Ports& ports = cell->ports();
+    if (is_register(cell->type()))
+    {
+        std::vector<signal_id_t> ins = {ports.m_dff.m_in_d};
+        if (dff_has_enable(cell->type()))
+            ins.push_back(test_is_reg_with_enable(cell->type()) ? ports.m_dffe.m_in_e
+                                                                : ports.m_dffer.m_in_e);
+        if (dff_has_reset(cell->type()))
+            ins.push_back(test_is_reg_with_reset(cell->type()) ? ports.m_dffr.m_in_r
+                                                               : ports.m_dffer.m_in_r);
+        return ins;
+    }
+    if (is_unary(cell->type())) return {ports.m_unr.m_in_a};
+    if (is_binary(cell->type())) return {ports.m_bin.m_in_a, ports.m_bin.m_in_b};
+    assert(is_multiplexer(cell->type()));
+    return {ports.m_mux.m_in_a, ports.m_mux.m_in_b, ports.m_mux.m_in_s};
+}
+
+sim_word_t sim_from_bool(bool b)
+{
+    return sim_word_t(b ? ~0ULL : 0ULL);
+}
+
+sim_word_t mux(sim_word_t cond, sim_word_t t_val, sim_word_t e_val)
+{
+    return sim_word_t((cond.bits & t_val.bits) | (~cond.bits & e_val.bits));
+}
+
+Simulator::Simulator(const Circuit& circuit) : m_circuit(circuit)
+{
+    uint32_t order = 0;
+    for (const Cell* cell : m_circuit.cells())
+    {
+        m_cell_order.emplace(cell, order++);
+        if (is_register(cell->type()))
+            m_drivers.emplace(cell->m_ports.m_dff.m_out_q, cell);
+        else
+            m_drivers.emplace(cell->m_ports.m_unr.m_out_y, cell);
+    }
+}
+
+const Cell* Simulator::driver(signal_id_t sig) const
+{
+    const auto& f = m_drivers.find(sig);
+    return (f == m_drivers.end()) ? nullptr : f->second;
+}
+
+uint64_t Simulator::truth_table(signal_id_t root, const std::vector<signal_id_t>& leaves) const
+{
+    if (leaves.size() > 6) throw std::logic_error(ILLEGAL_CONE_SIZE);
+
+    std::unordered_map<signal_id_t, sim_word_t> values;
+    values.emplace(signal_id_t::S_0, sim_from_bool(false));
+    values.emplace(signal_id_t::S_1, sim_from_bool(true));
+    values.emplace(signal_id_t::S_X, sim_from_bool(false));
+    values.emplace(signal_id_t::S_Z, sim_from_bool(false));
+    for (uint32_t pos = 0; pos < leaves.size(); pos++)
+        values[leaves.at(pos)] = sim_word_t(TT_VAR[pos]);
+
+    // Collect the cells of the cone between the leaves and the root
+    std::vector<const Cell*> cone;
+    std::unordered_map<signal_id_t, bool> visited;
+    std::vector<signal_id_t> to_visit = {root};
+    while (!to_visit.empty())
+    {
+        const signal_id_t sig = to_visit.back();
+        to_visit.pop_back();
+        if (values.find(sig) != values.end() || !visited.emplace(sig, true).second) continue;
+
+        const Cell* cell = driver(sig);
+        if (cell == nullptr || is_register(cell->type()))
+            throw std::logic_error(ILLEGAL_CONE_LEAVES);
+        cone.push_back(cell);
+
+        const Ports& ports = cell->m_ports;
+        to_visit.push_back(ports.m_unr.m_in_a);
+        if (is_binary(cell->type()) || is_multiplexer(cell->type()))
+            to_visit.push_back(ports.m_bin.m_in_b);
+        if (is_multiplexer(cell->type()))
+            to_visit.push_back(ports.m_mux.m_in_s);
+    }
+
+    std::sort(cone.begin(), cone.end(), [this](const Cell* a, const Cell* b)
+        { return m_cell_order.at(a) < m_cell_order.at(b); });
+
+    const std::unordered_map<signal_id_t, sim_word_t> empty;
+    for (const Cell* cell : cone)
+        cell->eval<sim_word_t, sim_word_t, sim_from_bool>(empty, values);
+
+    return values.at(root).bits;
+}
+
+bool Simulator::reset_value(signal_id_t reg, bool& value) const
+{
+    const Cell* cell = driver(reg);
+    if (cell == nullptr || !is_register(cell->type()) || !dff_has_reset(cell->type())) return false;
+
+    const bool r_only = test_is_reg_with_reset(cell->type());
+    const signal_id_t in_r = r_only ? cell->m_ports.m_dffr.m_in_r : cell->m_ports.m_dffer.m_in_r;
+    const bool trigger = dff_reset_trigger(cell->type());
+    if ((in_r == signal_id_t::S_0 && trigger) || (in_r == signal_id_t::S_1 && !trigger) ||
+        in_r == signal_id_t::S_X || in_r == signal_id_t::S_Z) return false;
+
+    value = dff_reset_value(cell->type());
+    return true;
+}
+
+bool Simulator::fanout_cone(signal_id_t site, uint32_t max_cells, std::vector<const Cell*>& cone) const
+{
+    std::unordered_set<const Cell*> visited;
+    std::vector<signal_id_t> to_visit = {site};
+    while (!to_visit.empty())
+    {
+        const signal_id_t sig = to_visit.back();
+        to_visit.pop_back();
+        for (const Cell* cell : m_circuit.get_fanout(sig))
+        {
+            if (!visited.emplace(cell).second) continue;
+            if (visited.size() > max_cells) return false;
+            cone.push_back(cell);
+            if (!is_register(cell->type())) to_visit.push_back(cell->m_ports.m_unr.m_out_y);
+        }
+    }
+    // Registers come first in the circuit but read the gates of the same cycle
+    std::sort(cone.begin(), cone.end(), [this](const Cell* a, const Cell* b)
+        { return std::make_pair(is_register(a->type()), m_cell_order.at(a)) <
+                 std::make_pair(is_register(b->type()), m_cell_order.at(b)); });
+    return true;
+}
+
+std::unordered_map<signal_id_t, std::vector<uint64_t>> Simulator::simulate_from_reset(uint32_t cycles,
+                                                                                     uint64_t seed) const
+{
+    std::mt19937_64 rng(seed);
+    std::unordered_map<signal_id_t, std::vector<uint64_t>> values;
+
+    std::vector<signal_id_t> regs(m_circuit.regs().begin(), m_circuit.regs().end());
+    std::vector<signal_id_t> ins(m_circuit.ins().begin(), m_circuit.ins().end());
+    std::sort(regs.begin(), regs.end());
+    std::sort(ins.begin(), ins.end());
+
+    const std::unordered_map<signal_id_t, sim_word_t> empty;
+    std::unordered_map<signal_id_t, sim_word_t> prev_state;
+    for (uint32_t cycle = 0; cycle < cycles; cycle++)
+    {
+        std::unordered_map<signal_id_t, sim_word_t> state;
+        state.emplace(signal_id_t::S_0, sim_from_bool(false));
+        state.emplace(signal_id_t::S_1, sim_from_bool(true));
+        state.emplace(signal_id_t::S_X, sim_from_bool(false));
+        state.emplace(signal_id_t::S_Z, sim_from_bool(false));
+        for (signal_id_t sig : ins)
+            state.emplace(sig, sim_word_t(rng()));
+
+        for (signal_id_t sig : regs)
+        {
+            bool value;
+            if (cycle > 0)
+                driver(sig)->eval<sim_word_t, sim_word_t, sim_from_bool>(prev_state, state);
+            else if (reset_value(sig, value))
+                state.emplace(sig, sim_from_bool(value));
+            else
+                state.emplace(sig, sim_word_t(rng()));
+            values[sig].push_back(state.at(sig).bits);
+        }
+
+        for (const Cell* cell : m_circuit.cells())
+        {
+            if (!is_register(cell->type()))
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(empty, state);
+        }
+        prev_state = std::move(state);
+    }
+    return values;
+}
@@ -0,0 +1,82 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Circuit.h"
+
+constexpr const char* ILLEGAL_CONE_LEAVES = "Cone of signal is not bounded by the provided leaves";
+constexpr const char* ILLEGAL_CONE_SIZE   = "Truth tables are limited to 6 leaves";
+
+///////////   Sim_word_t   /////////////////////////////////////////////////////
+// 64 independent evaluations of a signal, one per bit, usable with Cell::eval
+
+struct sim_word_t
+{
+    uint64_t bits;
+    sim_word_t() : bits(0) {}
+    explicit sim_word_t(uint64_t b) : bits(b) {}
+    sim_word_t operator!() const { return sim_word_t(~bits); }
+    sim_word_t operator+() const { return *this; }
+    sim_word_t operator&(const sim_word_t& o) const { return sim_word_t(bits & o.bits); }
+    sim_word_t operator|(const sim_word_t& o) const { return sim_word_t(bits | o.bits); }
+    sim_word_t operator^(const sim_word_t& o) const { return sim_word_t(bits ^ o.bits); }
+    bool operator==(const sim_word_t& o) const { return bits == o.bits; }
+};
+
+bool is_constant(signal_id_t sig);
+// Signals read by a cell, except the clock of registers
+std::vector<signal_id_t> cell_inputs(const Cell* cell);
+
+sim_word_t sim_from_bool(bool b);
+sim_word_t mux(sim_word_t cond, sim_word_t t_val, sim_word_t e_val);
+
+// Truth table of the i-th variable of a function of at most 6 variables
+extern const uint64_t TT_VAR[6];
+
+class Simulator
+{
+protected:
+    const Circuit& m_circuit;
+    std::unordered_map<signal_id_t, const Cell*> m_drivers;
+    std::unordered_map<const Cell*, uint32_t> m_cell_order;
+public:
+    explicit Simulator(const Circuit& circuit);
+    const Cell* driver(signal_id_t sig) const;
+    /*  Truth table of `root` as a function of `leaves`, the i-th leaf being
+     *  the i-th variable. Registers and inputs must be leaves of the cone
+     */
+    uint64_t truth_table(signal_id_t root, const std::vector<signal_id_t>& leaves) const;
+    /*  Value taken by register `reg` on reset.
+     *  Returns false if it has no reset, or a reset that is never triggered
+     */
+    bool reset_value(signal_id_t reg, bool& value) const;
+    /*  Cells reading `site` directly or through gates, up to registers, in
+     *  evaluation order. Returns false if the cone exceeds `max_cells` cells
+     */
+    bool fanout_cone(signal_id_t site, uint32_t max_cells, std::vector<const Cell*>& cone) const;
+    /*  Values of the registers during `cycles` clock cycles of 64 simulations
+     *  starting from reset, one per bit. Inputs and initial values of
+     *  registers without reset are drawn at random from `seed`
+     */
+    std::unordered_map<signal_id_t, std::vector<uint64_t>> simulate_from_reset(uint32_t cycles,
+                                                                              uint64_t seed) const;
+};
+
+#endif // SIMULATOR_H
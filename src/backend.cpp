@@ -0,0 +1,238 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <cstdlib>
+#include <stdexcept>
+
+#include <dlfcn.h>
+
+#include "backend.h"
+
+///////////   SatBackend   /////////////////////////////////////////////////////
+
+int SatBackend::true_lit()
+{
+    if (m_true == 0) {
+        m_true = new_var();
+        add_clause({m_true});
+    }
+    return m_true;
+}
+
+int SatBackend::make_and(const std::vector<int>& ops)
+{
+    if (ops.empty()) return true_lit();
+    if (ops.size() == 1) return ops.front();
+
+    const int y = new_var();
+    std::vector<int> ops_imply_y = {y};
+    for (const int op : ops)
+    {
+        add_clause({-y, op});
+        ops_imply_y.push_back(-op);
+    }
+    add_clause(ops_imply_y);
+    return y;
+}
+
+int SatBackend::make_or(const std::vector<int>& ops)
+{
+    std::vector<int> negated;
+    for (const int op : ops) negated.push_back(-op);
+    return -make_and(negated);
+}
+
+int SatBackend::make_at_most(const std::vector<int>& ops, uint32_t k)
+{
+    if (ops.size() <= k) return true_lit();
+
+    // `count.at(j)` is implied when more than `j` processed operands are true
+    const int act = new_var();
+    std::vector<int> count;
+    for (const int op : ops)
+    {
+        if (k == 0) {
+            add_clause({-act, -op});
+            continue;
+        }
+        if (count.size() == k) add_clause({-act, -op, -count.at(k - 1)});
+        std::vector<int> next;
+        for (uint32_t j = 0; j < k; j++)
+        {
+            const int s = new_var();
+            if (j == 0) add_clause({-op, s});
+            else if (j <= count.size()) add_clause({-op, -count.at(j - 1), s});
+            if (j < count.size()) add_clause({-count.at(j), s});
+            next.push_back(s);
+        }
+        count = std::move(next);
+    }
+    return act;
+}
+
+int SatBackend::make_at_least(const std::vector<int>& ops, uint32_t k)
+{
+    if (k > ops.size()) return -true_lit();
+    std::vector<int> negated;
+    for (const int op : ops) negated.push_back(-op);
+    return make_at_most(negated, ops.size() - k);
+}
+
+///////////   CxxsatBackend   //////////////////////////////////////////////////
+
+var_t CxxsatBackend::to_var(int lit) const
+{
+    const var_t& var = m_vars.at(std::abs(lit));
+    return lit < 0 ? !var : var;
+}
+
+int CxxsatBackend::new_var()
+{
+    m_vars.push_back(m_solver.new_var());
+    return m_vars.size() - 1;
+}
+
+void CxxsatBackend::add_clause(const std::vector<int>& lits)
+{
+    // Longer clauses are chained through fresh variables
+    std::vector<var_t> clause;
+    for (size_t idx = 0; idx < lits.size(); idx++)
+    {
+        if (clause.size() == 6 && lits.size() - idx > 1) {
+            const var_t link = m_solver.new_var();
+            clause.push_back(link);
+            m_solver.add_clause(clause[0], clause[1], clause[2], clause[3], clause[4], clause[5], clause[6]);
+            clause = {!link};
+        }
+        clause.push_back(to_var(lits.at(idx)));
+    }
+
+    switch (clause.size())
+    {
+        case 1: m_solver.add_clause(clause[0]); break;
+        case 2: m_solver.add_clause(clause[0], clause[1]); break;
+        case 3: m_solver.add_clause(clause[0], clause[1], clause[2]); break;
+        case 4: m_solver.add_clause(clause[0], clause[1], clause[2], clause[3]); break;
+        case 5: m_solver.add_clause(clause[0], clause[1], clause[2], clause[3], clause[4]); break;
+        case 6: m_solver.add_clause(clause[0], clause[1], clause[2], clause[3], clause[4], clause[5]); break;
+        case 7: m_solver.add_clause(clause[0], clause[1], clause[2], clause[3], clause[4], clause[5], clause[6]); break;
+        default: throw std::logic_error(ILLEGAL_CLAUSE_SIZE);
+    }
+}
+
+void CxxsatBackend::assume(int lit)
+{
+    m_solver.assume(to_var(lit));
+}
+
+cxxsat::Solver::state_t CxxsatBackend::check()
+{
+    return m_solver.check();
+}
+
+bool CxxsatBackend::value(int lit)
+{
+    return m_solver.value(to_var(lit));
+}
+
+///////////   IpasirBackend   //////////////////////////////////////////////////
+
+template <typename F>
+static F ipasir_function(void* library, const char* name)
+{
+    void* f = dlsym(library, name);
+    if (f == nullptr) throw std::logic_error(std::string(ILLEGAL_BACKEND_SYMBOL) + ": " + name);
+    return reinterpret_cast<F>(f);
+}
+
+IpasirBackend::IpasirBackend(const std::string& library)
+{
+    // Each backend opens the library, which is loaded once by the system
+    m_library = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (m_library == nullptr) throw std::logic_error(std::string(ILLEGAL_BACKEND_LIBRARY) + ": " + dlerror());
+
+    m_signature = ipasir_function<const char* (*)()>(m_library, "ipasir_signature")();
+    m_release = ipasir_function<void (*)(void*)>(m_library, "ipasir_release");
+    m_add = ipasir_function<void (*)(void*, int32_t)>(m_library, "ipasir_add");
+    m_assume = ipasir_function<void (*)(void*, int32_t)>(m_library, "ipasir_assume");
+    m_solve = ipasir_function<int (*)(void*)>(m_library, "ipasir_solve");
+    m_val = ipasir_function<int32_t (*)(void*, int32_t)>(m_library, "ipasir_val");
+    m_solver = ipasir_function<void* (*)()>(m_library, "ipasir_init")();
+}
+
+IpasirBackend::~IpasirBackend()
+{
+    m_release(m_solver);
+    dlclose(m_library);
+}
+
+void IpasirBackend::add_clause(const std::vector<int>& lits)
+{
+    for (const int lit : lits) m_add(m_solver, lit);
+    m_add(m_solver, 0);
+}
+
+void IpasirBackend::assume(int lit)
+{
+    m_assume(m_solver, lit);
+}
+
+cxxsat::Solver::state_t IpasirBackend::check()
+{
+    switch (m_solve(m_solver))
+    {
+        case 10: return cxxsat::Solver::state_t::STATE_SAT;
+        case 20: return cxxsat::Solver::state_t::STATE_UNSAT;
+        default: throw std::logic_error(ILLEGAL_BACKEND_ANSWER);
+    }
+}
+
+bool IpasirBackend::value(int lit)
+{
+    // Variables left free by the model are read as false
+    const int32_t val = m_val(m_solver, std::abs(lit));
+    return lit < 0 ? val < 0 : val > 0;
+}
+
+std::unique_ptr<SatBackend> make_backend(const std::string& library)
+{
+    if (library.empty()) return std::make_unique<CxxsatBackend>();
+    return std::make_unique<IpasirBackend>(library);
+}
+
+///////////   Cnf_sync_t   /////////////////////////////////////////////////////
+
+int to_backend(const cnf_sync_t& sync, lit_t lit)
+{
+    const int var = sync.vars.at(lit.code >> 1);
+    return (lit.code & 1) ? -var : var;
+}
+
+void sync_cnf(const Cnf& cnf, SatBackend& backend, cnf_sync_t& sync)
+{
+    // Variable 0 of the CNF is the constant true
+    if (sync.vars.empty()) sync.vars.push_back(backend.true_lit());
+    while (sync.vars.size() < cnf.num_vars())
+        sync.vars.push_back(backend.new_var());
+
+    const std::vector<uint32_t>& clauses = cnf.clauses();
+    std::vector<int> clause;
+    for (; sync.clause_pos < clauses.size(); sync.clause_pos += 1 + clauses.at(sync.clause_pos))
+    {
+        clause.clear();
+        for (uint32_t idx = 1; idx <= clauses.at(sync.clause_pos); idx++)
+            clause.push_back(to_backend(sync, lit_t(clauses.at(sync.clause_pos + idx))));
+        backend.add_clause(clause);
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_BACKEND_H
+#define VERIFIER_BACKEND_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+#include "vars.h"
+#include "cnf.h"
+
+using var_t = cxxsat::var_t;
+
+constexpr const char* ILLEGAL_BACKEND_LIBRARY = "Cannot load the IPASIR library of `sat_backend`";
+constexpr const char* ILLEGAL_BACKEND_SYMBOL  = "IPASIR library of `sat_backend` misses a function";
+constexpr const char* ILLEGAL_BACKEND_ANSWER  = "IPASIR solver was interrupted";
+constexpr const char* ILLEGAL_BACKEND_MODEL   = "Model of `sat_backend` does not hold in the solver";
+
+///////////   SatBackend   /////////////////////////////////////////////////////
+// An incremental SAT solver owned by its user, with DIMACS literals: variable
+// `v` > 0, negated as `-v`. Unlike the global `cxxsat::solver`, several
+// backends can live side by side. Gates and cardinality constraints are
+// encoded with clauses here, so that every backend offers them
+
+class SatBackend
+{
+private:
+    int m_true = 0;
+
+public:
+    virtual ~SatBackend() = default;
+    virtual std::string name() const = 0;
+    virtual int new_var() = 0;
+    virtual void add_clause(const std::vector<int>& lits) = 0;
+    // Assumptions hold for the next check only
+    virtual void assume(int lit) = 0;
+    virtual cxxsat::Solver::state_t check() = 0;
+    virtual bool value(int lit) = 0;
+
+    // Literal forced true
+    int true_lit();
+    int make_and(const std::vector<int>& ops);
+    int make_or(const std::vector<int>& ops);
+    // Literals implying that at most/at least `k` of `ops` are true, with
+    // sequential counters
+    int make_at_most(const std::vector<int>& ops, uint32_t k);
+    int make_at_least(const std::vector<int>& ops, uint32_t k);
+};
+
+// Backend running a `cxxsat::Solver` of its own
+class CxxsatBackend : public SatBackend
+{
+private:
+    cxxsat::Solver m_solver;
+    // Solver variable of each backend variable, from 1
+    std::vector<var_t> m_vars;
+    var_t to_var(int lit) const;
+
+public:
+    CxxsatBackend() : m_vars(1) {};
+    std::string name() const override { return "cxxsat"; }
+    int new_var() override;
+    void add_clause(const std::vector<int>& lits) override;
+    void assume(int lit) override;
+    cxxsat::Solver::state_t check() override;
+    bool value(int lit) override;
+};
+
+// Backend running any solver of the IPASIR interface, loaded at runtime
+class IpasirBackend : public SatBackend
+{
+private:
+    void* m_library;
+    void* m_solver;
+    int m_num_vars = 0;
+    std::string m_signature;
+
+    void (*m_release)(void*);
+    void (*m_add)(void*, int32_t);
+    void (*m_assume)(void*, int32_t);
+    int (*m_solve)(void*);
+    int32_t (*m_val)(void*, int32_t);
+
+public:
+    explicit IpasirBackend(const std::string& library);
+    ~IpasirBackend() override;
+    IpasirBackend(const IpasirBackend&) = delete;
+    IpasirBackend& operator=(const IpasirBackend&) = delete;
+    std::string name() const override { return m_signature; }
+    int new_var() override { return ++m_num_vars; }
+    void add_clause(const std::vector<int>& lits) override;
+    void assume(int lit) override;
+    cxxsat::Solver::state_t check() override;
+    bool value(int lit) override;
+};
+
+// IPASIR backend of the shared library `library`, cxxsat if empty
+std::unique_ptr<SatBackend> make_backend(const std::string& library);
+
+///////////   Cnf_sync_t   /////////////////////////////////////////////////////
+// Part of a growing `Cnf` already loaded into a backend
+
+struct cnf_sync_t
+{
+    // Backend literal of each CNF variable
+    std::vector<int> vars;
+    // Position of the first clause not loaded yet
+    size_t clause_pos = 0;
+};
+
+// Load the variables and clauses added to `cnf` since the last call
+void sync_cnf(const Cnf& cnf, SatBackend& backend, cnf_sync_t& sync);
+
+int to_backend(const cnf_sync_t& sync, lit_t lit);
+
+#endif // VERIFIER_BACKEND_H
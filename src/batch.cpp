@@ -0,0 +1,192 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+#include <fnmatch.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "parallel.h"
+#include "json.hpp"
+
+struct running_t
+{
+    pid_t pid;
+    uint32_t job;
+    std::string design_key;
+    std::chrono::steady_clock::time_point start;
+};
+
+static uint64_t resident_mb(pid_t pid)
+{
+    std::ifstream f("/proc/" + std::to_string(pid) + "/statm");
+    uint64_t size = 0, resident = 0;
+    f >> size >> resident;
+    return (resident * sysconf(_SC_PAGESIZE)) >> 20;
+}
+
+uint64_t available_memory_mb()
+{
+    std::ifstream f("/proc/meminfo");
+    std::string key;
+    uint64_t kb;
+    while (f >> key >> kb)
+    {
+        if (key == "MemAvailable:") return kb >> 10;
+        f.ignore(256, '\n');
+    }
+    return (uint64_t(sysconf(_SC_AVPHYS_PAGES)) * sysconf(_SC_PAGESIZE)) >> 20;
+}
+
+std::vector<batch_job_t> match_configs(const std::string& config_file,
+                                       const std::vector<std::string>& patterns)
+{
+    std::ifstream f; f.exceptions(std::ifstream::badbit);
+    f.open(config_file);
+    std::string data(std::istreambuf_iterator<char>{f}, {});
+    f.close();
+    auto pdata = nlohmann::json::parse(data);
+
+    std::vector<batch_job_t> jobs;
+    std::vector<bool> matched(patterns.size(), false);
+    for (const auto& config : pdata.items())
+    {
+        bool selected = false;
+        for (size_t idx = 0; idx < patterns.size(); idx++)
+        {
+            if (fnmatch(patterns.at(idx).c_str(), config.key().c_str(), 0) != 0) continue;
+            matched.at(idx) = true;
+            selected = true;
+        }
+        if (selected)
+            jobs.push_back({config.key(), config.value().at("design_path"), config.value().at("design_name")});
+    }
+
+    for (size_t idx = 0; idx < patterns.size(); idx++)
+    {
+        if (!matched.at(idx)) {
+            std::cerr << patterns.at(idx) << std::endl;
+            throw std::logic_error(ILLEGAL_BATCH_PATTERN);
+        }
+    }
+    return jobs;
+}
+
+uint32_t run_batch(const std::vector<batch_job_t>& jobs, uint32_t max_jobs,
+                   uint64_t mem_budget_mb, const batch_run_t& run, std::ostream& out)
+{
+    // Jobs of a design follow each other, so that the parent holds a single
+    // parsed design at a time
+    std::map<std::string, uint32_t> design_rank;
+    std::vector<std::string> design_keys;
+    for (const batch_job_t& job : jobs)
+    {
+        design_keys.push_back(job.design_path + ":" + job.design_name);
+        design_rank.emplace(design_keys.back(), design_rank.size());
+    }
+    std::vector<uint32_t> order(jobs.size());
+    for (uint32_t idx = 0; idx < jobs.size(); idx++) order.at(idx) = idx;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        { return design_rank.at(design_keys.at(a)) < design_rank.at(design_keys.at(b)); });
+
+    // Expected memory of a job: the parsed design until one of its jobs
+    // finishes, then the largest peak of its finished jobs
+    std::map<std::string, uint64_t> design_mb;
+    Circuit* design = nullptr;
+    std::string design_key;
+
+    std::vector<running_t> running;
+    uint32_t next = 0;
+    uint32_t failed = 0;
+    while (next < order.size() || !running.empty())
+    {
+        while (next < order.size() && running.size() < std::max(max_jobs, uint32_t(1)))
+        {
+            const uint32_t job_idx = order.at(next);
+            const batch_job_t& job = jobs.at(job_idx);
+            if (design_keys.at(job_idx) != design_key) {
+                // Running jobs keep their own copy of the previous design
+                delete design;
+                const uint64_t before_mb = resident_mb(getpid());
+                const auto start_parse{std::chrono::steady_clock::now()};
+                design = new Circuit(job.design_path, job.design_name);
+                const auto end_parse{std::chrono::steady_clock::now()};
+                design_key = design_keys.at(job_idx);
+                const uint64_t after_mb = resident_mb(getpid());
+                design_mb.emplace(design_key, std::max(after_mb, before_mb + 1) - before_mb);
+                uint32_t parse_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_parse - start_parse).count();
+                out << "Parsed design `" << job.design_name << "` of `" << job.design_path << "` in ";
+                out << parse_ms / 1000 << "." << (parse_ms % 1000) << " s" << std::endl;
+            }
+
+            uint64_t used_mb = 0;
+            for (const running_t& r : running)
+                used_mb += std::max(resident_mb(r.pid), design_mb.at(r.design_key));
+            if (!running.empty() && used_mb + design_mb.at(design_key) > mem_budget_mb) break;
+
+            out << "Start `" << job.config_name << "` (" << used_mb << " MB in use)" << std::endl;
+            const pid_t pid = fork();
+            if (pid < 0) throw std::logic_error(ILLEGAL_FORK);
+            if (pid == 0) {
+                int status = 1;
+                try {
+                    run(job.config_name, design);
+                    status = 0;
+                } catch (const std::exception& e) {
+                    std::cerr << job.config_name << ": " << e.what() << std::endl;
+                }
+                _exit(status);
+            }
+            running.push_back({pid, job_idx, design_key, std::chrono::steady_clock::now()});
+            next++;
+        }
+
+        int status = 0;
+        struct rusage usage;
+        const pid_t pid = wait4(-1, &status, WNOHANG, &usage);
+        if (pid < 0 && errno == EINTR) continue;
+        if (pid < 0) throw std::logic_error(ILLEGAL_WORKER_EXIT);
+        if (pid == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(BATCH_POLL_MS));
+            continue;
+        }
+
+        const auto it = std::find_if(running.begin(), running.end(),
+            [&](const running_t& r) { return r.pid == pid; });
+        if (it == running.end()) continue;
+        const bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        const uint64_t peak_mb = usage.ru_maxrss >> 10;
+        uint64_t& expected_mb = design_mb.at(it->design_key);
+        expected_mb = std::max(expected_mb, peak_mb);
+        if (!ok) failed++;
+
+        uint32_t job_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - it->start).count();
+        out << "Done `" << jobs.at(it->job).config_name << "`: " << (ok ? "ok" : "FAILED");
+        out << " in " << job_ms / 1000 << "." << (job_ms % 1000) << " s, peak " << peak_mb << " MB" << std::endl;
+        running.erase(it);
+    }
+    delete design;
+    return failed;
+}
@@ -0,0 +1,58 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_BATCH_H
+#define VERIFIER_BATCH_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Circuit.h"
+
+constexpr const char* ILLEGAL_BATCH_PATTERN = "No configuration matches batch pattern";
+
+// Delay between two looks at the running jobs
+#define BATCH_POLL_MS 100
+
+// Check of a configuration on its parsed design, run in a forked process
+using batch_run_t = std::function<void(const std::string&, Circuit*)>;
+
+struct batch_job_t
+{
+    std::string config_name;
+    std::string design_path;
+    std::string design_name;
+};
+
+// Configurations of `config_file` matching the glob patterns, in file order
+std::vector<batch_job_t> match_configs(const std::string& config_file,
+                                       const std::vector<std::string>& patterns);
+
+/*  Run the jobs in forked processes, at most `max_jobs` at a time:
+ *  - each distinct design is parsed once in the parent, right before its
+ *    first job, and shared copy-on-write by its jobs
+ *  - a job starts only if the resident memory of the running jobs, counted at
+ *    least as the peak of finished jobs of the same design, leaves room for it
+ *    within `mem_budget_mb`. A single job always runs
+ *  Progress is logged to `out`. Returns the number of failed jobs
+ */
+uint32_t run_batch(const std::vector<batch_job_t>& jobs, uint32_t max_jobs,
+                   uint64_t mem_budget_mb, const batch_run_t& run, std::ostream& out);
+
+// Memory available on the machine, used as default budget
+uint64_t available_memory_mb();
+
+#endif // VERIFIER_BATCH_H
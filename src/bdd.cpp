@@ -0,0 +1,153 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "bdd.h"
+
+namespace bdd {
+
+Manager* manager = nullptr;
+
+// Variable of the constant node, after all the others
+constexpr uint32_t TERMINAL_VAR = std::numeric_limits<uint32_t>::max();
+
+size_t Manager::key_hash_t::operator()(const key_t& k) const
+{
+    uint64_t h = k.a;
+    h = h * 0x9E3779B97F4A7C15ULL + k.b;
+    h = h * 0x9E3779B97F4A7C15ULL + k.c;
+    return h ^ (h >> 29);
+}
+
+Manager::Manager(uint32_t max_nodes) : m_max_nodes(max_nodes)
+{
+    m_nodes.push_back({TERMINAL_VAR, ONE, ONE});
+}
+
+edge_t Manager::make_node(uint32_t var, edge_t high, edge_t low)
+{
+    if (high == low) return high;
+    // Keep high edges regular
+    if (high & 1) return make_node(var, high ^ 1, low ^ 1) ^ 1;
+
+    const key_t key = {var, high, low};
+    const auto& f = m_unique.find(key);
+    if (f != m_unique.end()) return f->second;
+
+    if (m_nodes.size() >= m_max_nodes) {
+        m_overflow = true;
+        return ZERO;
+    }
+    const edge_t edge = m_nodes.size() << 1;
+    m_nodes.push_back({var, high, low});
+    m_unique.emplace(key, edge);
+    return edge;
+}
+
+uint32_t Manager::top_var(edge_t f) const
+{
+    return m_nodes.at(f >> 1).var;
+}
+
+void Manager::cofactors(edge_t f, uint32_t var, edge_t& high, edge_t& low) const
+{
+    const node_t& node = m_nodes.at(f >> 1);
+    if (node.var != var) {
+        high = low = f;
+        return;
+    }
+    high = node.high ^ (f & 1);
+    low = node.low ^ (f & 1);
+}
+
+edge_t Manager::new_var()
+{
+    return make_node(m_num_vars++, ONE, ZERO);
+}
+
+edge_t Manager::ite(edge_t f, edge_t g, edge_t h)
+{
+    if (m_overflow) return ZERO;
+
+    // Operands equal to the condition
+    if (g == f) g = ONE;
+    else if (g == (f ^ 1)) g = ZERO;
+    if (h == f) h = ZERO;
+    else if (h == (f ^ 1)) h = ONE;
+
+    if (f == ONE || g == h) return g;
+    if (f == ZERO) return h;
+    if (g == ONE && h == ZERO) return f;
+    if (g == ZERO && h == ONE) return f ^ 1;
+
+    // Regular condition and then-branch, the complement moving to the result
+    if (f & 1) {
+        f ^= 1;
+        std::swap(g, h);
+    }
+    edge_t complement = 0;
+    if (g & 1) {
+        g ^= 1;
+        h ^= 1;
+        complement = 1;
+    }
+
+    const key_t key = {f, g, h};
+    const auto& f_computed = m_computed.find(key);
+    if (f_computed != m_computed.end()) return f_computed->second ^ complement;
+
+    const uint32_t var = std::min({top_var(f), top_var(g), top_var(h)});
+    edge_t f_high, f_low, g_high, g_low, h_high, h_low;
+    cofactors(f, var, f_high, f_low);
+    cofactors(g, var, g_high, g_low);
+    cofactors(h, var, h_high, h_low);
+
+    const edge_t high = ite(f_high, g_high, h_high);
+    const edge_t low = ite(f_low, g_low, h_low);
+    const edge_t result = make_node(var, high, low);
+    if (m_overflow) return ZERO;
+
+    m_computed.emplace(key, result);
+    return result ^ complement;
+}
+
+edge_t Manager::at_most(const std::vector<edge_t>& ops, uint32_t k)
+{
+    // `counts[j]` holds if at most `j` of the processed operands are true
+    std::vector<edge_t> counts(k + 1, ONE);
+    for (const edge_t op : ops)
+    {
+        for (uint32_t j = k; j > 0; j--)
+            counts.at(j) = ite(op, counts.at(j - 1), counts.at(j));
+        counts.at(0) = ite(op, ZERO, counts.at(0));
+    }
+    return counts.at(k);
+}
+
+} // namespace bdd
+
+const bdd_t bdd_t::ZERO = bdd_t(bdd::ZERO);
+const bdd_t bdd_t::ONE = bdd_t(bdd::ONE);
+
+bdd_t bdd_from_bool(bool b)
+{
+    return b ? bdd_t::ONE : bdd_t::ZERO;
+}
+
+bdd_t mux(bdd_t cond, bdd_t t_val, bdd_t e_val)
+{
+    return bdd_t(bdd::manager->ite(cond.edge, t_val.edge, e_val.edge));
+}
@@ -0,0 +1,101 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_BDD_H
+#define VERIFIER_BDD_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+///////////   Bdd   ////////////////////////////////////////////////////////////
+// Reduced ordered binary decision diagrams with complement edges:
+//  - an edge is the index of its node shifted by one bit, the lowest bit
+//    complementing the function
+//  - node 0 is the constant 1, and the high edge of a node is never
+//    complemented, so that each function has a single edge
+//  - variables are ordered by creation
+// Once the node limit is reached, the manager overflows and every operation
+// returns the constant 0
+
+namespace bdd {
+
+using edge_t = uint32_t;
+constexpr edge_t ONE = 0;
+constexpr edge_t ZERO = 1;
+
+class Manager
+{
+protected:
+    struct node_t
+    {
+        uint32_t var;
+        edge_t high;
+        edge_t low;
+    };
+    struct key_t
+    {
+        uint32_t a, b, c;
+        bool operator==(const key_t& o) const { return a == o.a && b == o.b && c == o.c; }
+    };
+    struct key_hash_t
+    {
+        size_t operator()(const key_t& k) const;
+    };
+
+    std::vector<node_t> m_nodes;
+    std::unordered_map<key_t, edge_t, key_hash_t> m_unique;
+    std::unordered_map<key_t, edge_t, key_hash_t> m_computed;
+    uint32_t m_num_vars = 0;
+    uint32_t m_max_nodes;
+    bool m_overflow = false;
+
+    edge_t make_node(uint32_t var, edge_t high, edge_t low);
+    uint32_t top_var(edge_t f) const;
+    void cofactors(edge_t f, uint32_t var, edge_t& high, edge_t& low) const;
+public:
+    explicit Manager(uint32_t max_nodes);
+    edge_t new_var();
+    // If-then-else, from which all other operations derive
+    edge_t ite(edge_t f, edge_t g, edge_t h);
+    // At most `k` of the functions `ops` are true
+    edge_t at_most(const std::vector<edge_t>& ops, uint32_t k);
+    uint32_t num_nodes() const { return m_nodes.size(); }
+    bool overflow() const { return m_overflow; }
+};
+
+// Manager used by `bdd_t` operators
+extern Manager* manager;
+
+} // namespace bdd
+
+struct bdd_t
+{
+    bdd::edge_t edge;
+    static const bdd_t ZERO;
+    static const bdd_t ONE;
+    bdd_t() : edge(bdd::ZERO) {}
+    explicit bdd_t(bdd::edge_t e) : edge(e) {}
+    bdd_t operator!() const { return bdd_t(edge ^ 1); }
+    bdd_t operator+() const { return *this; }
+    bdd_t operator&(const bdd_t& o) const { return bdd_t(bdd::manager->ite(edge, o.edge, bdd::ZERO)); }
+    bdd_t operator|(const bdd_t& o) const { return bdd_t(bdd::manager->ite(edge, bdd::ONE, o.edge)); }
+    bdd_t operator^(const bdd_t& o) const { return bdd_t(bdd::manager->ite(edge, o.edge ^ 1, o.edge)); }
+    bool operator==(const bdd_t& o) const { return edge == o.edge; }
+};
+
+bdd_t bdd_from_bool(bool b);
+bdd_t mux(bdd_t cond, bdd_t t_val, bdd_t e_val);
+
+#endif // VERIFIER_BDD_H
@@ -0,0 +1,304 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include "cegar.h"
+
+using sim_state_t = std::unordered_map<signal_id_t, sim_word_t>;
+
+AbstractUnrolling::AbstractUnrolling(const Circuit& circuit,
+                                     std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+                                     std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                                     const std::unordered_set<signal_id_t>& faultable_sigs,
+                                     std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults,
+                                     const std::unordered_set<signal_id_t>& alert_signals,
+                                     const std::unordered_map<std::string, std::vector<bool>>& invariant_list,
+                                     const std::unordered_map<std::string, std::vector<bool>>& alert_list,
+                                     uint32_t depth)
+    : m_circuit(circuit), m_simulator(circuit), m_faultable_sigs(faultable_sigs),
+      m_alert_signals(alert_signals), m_alert_list(alert_list), m_golden_trace(golden_trace),
+      m_faulty_trace(faulty_trace), m_faults(faults)
+{
+    assert(golden_trace.empty());
+    assert(faulty_trace.empty());
+    assert(faults.empty());
+
+    m_refined_regs.resize(depth + 1);
+    m_read_regs.resize(depth + 1);
+    m_refined_alerts.assign(depth + 1, false);
+
+    for (const signal_id_t sig : m_circuit.regs())
+    {
+        m_next_regs.emplace(sig, std::vector<signal_id_t>());
+    }
+    for (const signal_id_t sig : m_circuit.regs())
+    {
+        for (const signal_id_t prev : m_circuit.get_prev_regs(sig)) m_next_regs.at(prev).push_back(sig);
+    }
+
+    // Registers are free at every clock cycle, as cuts after the first one
+    for (uint32_t cycle = 0; cycle <= depth; cycle++)
+    {
+        m_golden_trace.emplace_back();
+        m_faulty_trace.emplace_back();
+        m_faults.emplace_back();
+        init_constants(m_golden_trace.back());
+        init_constants(m_faulty_trace.back());
+        for (const signal_id_t sig : m_circuit.regs())
+        {
+            m_golden_trace.back().emplace(sig, cxxsat::solver->new_var());
+            m_faulty_trace.back().emplace(sig, cxxsat::solver->new_var());
+        }
+    }
+
+    // Assume invariant on golden trace
+    for (const auto& inv : invariant_list)
+    {
+        for (const signal_id_t sig : m_circuit[inv.first]) materialize(0, sig);
+    }
+    assert_invariants_at_step(m_circuit, m_golden_trace, invariant_list, 0);
+}
+
+/*  Encode the cone of `sig` at `cycle` down to encoded signals, registers and
+ *  inputs. Faults are inserted as in the concrete unrolling
+ */
+void AbstractUnrolling::materialize(uint32_t cycle, signal_id_t sig)
+{
+    std::unordered_map<signal_id_t, var_t>& golden_state = m_golden_trace.at(cycle);
+    std::unordered_map<signal_id_t, var_t>& faulty_state = m_faulty_trace.at(cycle);
+    std::unordered_map<signal_id_t, fault_spec_t>& current_faults = m_faults.at(cycle);
+    const std::unordered_map<signal_id_t, var_t> empty;
+
+    std::vector<signal_id_t> to_visit = {sig};
+    while (!to_visit.empty())
+    {
+        const signal_id_t s = to_visit.back();
+        if (m_circuit.regs().find(s) != m_circuit.regs().end()) m_read_regs.at(cycle).emplace(s);
+        if (golden_state.find(s) != golden_state.end()) {
+            to_visit.pop_back();
+            continue;
+        }
+
+        const bool faultable = m_faultable_sigs.find(s) != m_faultable_sigs.end();
+        const Cell* cell = m_simulator.driver(s);
+        if (cell == nullptr) {
+            to_visit.pop_back();
+            golden_state.emplace(s, cxxsat::solver->new_var());
+            if (faultable) {
+                fault_spec_t f;
+                current_faults.emplace(s, f);
+                faulty_state.emplace(s, f.induce_fault(golden_state.at(s)));
+            } else {
+                faulty_state.emplace(s, golden_state.at(s));
+            }
+            continue;
+        }
+        assert(!is_register(cell->type()));
+
+        bool ready = true;
+        for (const signal_id_t in : cell_inputs(cell))
+        {
+            if (m_circuit.regs().find(in) != m_circuit.regs().end()) m_read_regs.at(cycle).emplace(in);
+            if (golden_state.find(in) != golden_state.end()) continue;
+            to_visit.push_back(in);
+            ready = false;
+        }
+        if (!ready) continue;
+        to_visit.pop_back();
+
+        cell->eval<var_t, var_t&, make_const<var_t>>(empty, golden_state);
+        cell->eval<var_t, var_t&, make_const<var_t>>(empty, faulty_state);
+        if (!faultable) continue;
+
+        // After the first clock cycle, only gates connected to alerts are faulted
+        bool connected = (cycle == 0);
+        for (const signal_id_t& out : *m_circuit.get_conn_outs(s))
+            connected |= m_alert_signals.find(out) != m_alert_signals.end();
+        if (connected) {
+            fault_spec_t f;
+            current_faults.emplace(s, f);
+            faulty_state.at(s) = f.induce_fault(faulty_state.at(s));
+        }
+    }
+}
+
+void AbstractUnrolling::refine_reg(uint32_t cycle, signal_id_t reg)
+{
+    assert(cycle > 0);
+    const Cell* cell = m_simulator.driver(reg);
+    materialize(cycle - 1, reg);
+    for (const signal_id_t in : cell_inputs(cell)) materialize(cycle - 1, in);
+
+    std::unordered_map<signal_id_t, var_t> golden_next;
+    std::unordered_map<signal_id_t, var_t> faulty_next;
+    cell->eval<var_t, var_t&, make_const<var_t>>(m_golden_trace.at(cycle - 1), golden_next);
+    cell->eval<var_t, var_t&, make_const<var_t>>(m_faulty_trace.at(cycle - 1), faulty_next);
+
+    // Tie the cut to the next value
+    const var_t g = m_golden_trace.at(cycle).at(reg);
+    const var_t f = m_faulty_trace.at(cycle).at(reg);
+    cxxsat::solver->add_clause(-g, golden_next.at(reg));
+    cxxsat::solver->add_clause(g, -golden_next.at(reg));
+    cxxsat::solver->add_clause(-f, faulty_next.at(reg));
+    cxxsat::solver->add_clause(f, -faulty_next.at(reg));
+    m_refined_regs.at(cycle).emplace(reg);
+}
+
+void AbstractUnrolling::refine_alerts(uint32_t cycle)
+{
+    for (const auto& alert : m_alert_list)
+    {
+        for (const signal_id_t sig : m_circuit[alert.first]) materialize(cycle, sig);
+    }
+    // Assume no alert at this step
+    assert_no_alert_at_step(m_circuit, m_golden_trace, m_faulty_trace, m_alert_list, cycle);
+    m_refined_alerts.at(cycle) = true;
+}
+
+uint32_t AbstractUnrolling::refine()
+{
+    // Signals true in the model, read at once per state
+    std::vector<signal_id_t> state_sigs(m_circuit.ins().begin(), m_circuit.ins().end());
+    state_sigs.insert(state_sigs.end(), m_circuit.regs().begin(), m_circuit.regs().end());
+    const auto true_sigs = [&state_sigs](const std::unordered_map<signal_id_t, var_t>& state)
+    {
+        std::unordered_set<signal_id_t> sigs;
+        for (const uint32_t idx : read_state(state, state_sigs).true_indexes(0, state_sigs.size()))
+            sigs.insert(state_sigs.at(idx));
+        return sigs;
+    };
+
+    std::vector<std::pair<uint32_t, signal_id_t>> refined_regs;
+    std::vector<uint32_t> refined_alerts;
+
+    // Replay the faults and inputs of the model, missing inputs being 0
+    const sim_state_t empty;
+    sim_state_t prev_golden_state;
+    sim_state_t prev_faulty_state;
+    for (uint32_t cycle = 0; cycle < m_golden_trace.size(); cycle++)
+    {
+        const std::unordered_map<signal_id_t, var_t>& abs_golden_state = m_golden_trace.at(cycle);
+        const std::unordered_map<signal_id_t, var_t>& abs_faulty_state = m_faulty_trace.at(cycle);
+        const std::unordered_map<signal_id_t, fault_spec_t>& current_faults = m_faults.at(cycle);
+        const std::unordered_set<signal_id_t> golden_true = true_sigs(abs_golden_state);
+        const std::unordered_set<signal_id_t> faulty_true = true_sigs(abs_faulty_state);
+        std::vector<signal_id_t> fault_sigs;
+        std::vector<var_t> fault_lits;
+        for (const auto& [sig, fault] : current_faults)
+        {
+            fault_sigs.push_back(sig);
+            fault_lits.push_back(fault.is_faulted());
+        }
+        std::unordered_set<signal_id_t> flipped_sigs;
+        for (const uint32_t idx : model_t(fault_lits).true_indexes(0, fault_lits.size()))
+            flipped_sigs.insert(fault_sigs.at(idx));
+        const auto flipped = [&flipped_sigs](signal_id_t sig) { return flipped_sigs.count(sig) != 0; };
+
+        sim_state_t golden_state;
+        sim_state_t faulty_state;
+        for (sim_state_t* state : {&golden_state, &faulty_state})
+        {
+            state->emplace(signal_id_t::S_0, sim_from_bool(false));
+            state->emplace(signal_id_t::S_1, sim_from_bool(true));
+            state->emplace(signal_id_t::S_X, sim_from_bool(false));
+            state->emplace(signal_id_t::S_Z, sim_from_bool(false));
+        }
+        for (const signal_id_t sig : m_circuit.ins())
+        {
+            const bool value = golden_true.count(sig) != 0;
+            golden_state.emplace(sig, sim_from_bool(value));
+            faulty_state.emplace(sig, sim_from_bool(value != flipped(sig)));
+        }
+
+        for (const Cell* cell : m_circuit.cells())
+        {
+            if (!is_register(cell->type())) {
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(empty, golden_state);
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(empty, faulty_state);
+                const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+                if (flipped(out_y)) faulty_state.at(out_y) = !faulty_state.at(out_y);
+            } else if (cycle == 0) {
+                const signal_id_t out_q = cell->ports().m_dff.m_out_q;
+                golden_state.emplace(out_q, sim_from_bool(golden_true.count(out_q) != 0));
+                faulty_state.emplace(out_q, sim_from_bool(faulty_true.count(out_q) != 0));
+            } else {
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(prev_golden_state, golden_state);
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(prev_faulty_state, faulty_state);
+            }
+        }
+
+        // Cuts disagreeing with the replay where the counterexample relies on them
+        for (const signal_id_t reg : m_circuit.regs())
+        {
+            if (cycle == 0 || m_refined_regs.at(cycle).find(reg) != m_refined_regs.at(cycle).end())
+                continue;
+            const bool g = golden_state.at(reg).bits & 1;
+            const bool f = faulty_state.at(reg).bits & 1;
+            const bool abs_g = golden_true.count(reg) != 0;
+            const bool abs_f = faulty_true.count(reg) != 0;
+            const bool claimed_diff = (cycle == 1) && (abs_g != abs_f) && (g == f);
+            const bool read = (m_read_regs.at(cycle).find(reg) != m_read_regs.at(cycle).end()) &&
+                              (abs_g != g || abs_f != f);
+            if (claimed_diff || read) refined_regs.emplace_back(cycle, reg);
+        }
+
+        // Alerts raised by the replay
+        if (!m_refined_alerts.at(cycle))
+        {
+            bool raised = false;
+            for (const auto& alert : m_alert_list)
+            {
+                const std::vector<signal_id_t>& sigs = m_circuit[alert.first];
+                for (uint32_t pos = 0; pos < sigs.size(); pos++)
+                {
+                    const bool value = alert.second.at(pos);
+                    raised |= (bool)(golden_state.at(sigs.at(pos)).bits & 1) != value;
+                    raised |= (bool)(faulty_state.at(sigs.at(pos)).bits & 1) != value;
+                }
+            }
+            if (raised) refined_alerts.push_back(cycle);
+        }
+
+        prev_golden_state = std::move(golden_state);
+        prev_faulty_state = std::move(faulty_state);
+    }
+
+    // The model is lost once clauses are added
+    for (const auto& [cycle, reg] : refined_regs) refine_reg(cycle, reg);
+    for (const uint32_t cycle : refined_alerts) refine_alerts(cycle);
+
+    // Registers fed by the same registers as a refined one are likely needed
+    // by the next counterexample, refine them at once
+    uint32_t siblings = 0;
+    for (const auto& [cycle, reg] : refined_regs)
+    {
+        for (const signal_id_t prev : m_circuit.get_prev_regs(reg))
+        {
+            for (const signal_id_t sibling : m_next_regs.at(prev))
+            {
+                if (m_refined_regs.at(cycle).find(sibling) != m_refined_regs.at(cycle).end()) continue;
+                refine_reg(cycle, sibling);
+                siblings++;
+            }
+        }
+    }
+    return refined_regs.size() + refined_alerts.size() + siblings;
+}
+
+uint32_t AbstractUnrolling::num_refined() const
+{
+    uint32_t refined = 0;
+    for (const auto& regs : m_refined_regs) refined += regs.size();
+    for (const bool alerts : m_refined_alerts) refined += alerts;
+    return refined;
+}
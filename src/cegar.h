@@ -0,0 +1,80 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_CEGAR_H
+#define VERIFIER_CEGAR_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Circuit.h"
+#include "Simulator.h"
+#include "utils.h"
+
+///////////   AbstractUnrolling   //////////////////////////////////////////////
+// Golden/faulty traces encoded on demand for counterexample-guided abstraction
+// refinement:
+//  - registers after the first clock cycle start as free cut signals, alerts
+//    are not asserted
+//  - refining a register (resp. the alerts) at a clock cycle encodes the
+//    cone of its next value (resp. of the alerts) and ties it to the cut
+//  - combinational faults only exist on the encoded gates
+// The traces only hold the encoded signals, with the same layout as the
+// concrete unrolling
+
+class AbstractUnrolling
+{
+protected:
+    const Circuit& m_circuit;
+    const Simulator m_simulator;
+    const std::unordered_set<signal_id_t>& m_faultable_sigs;
+    const std::unordered_set<signal_id_t>& m_alert_signals;
+    const std::unordered_map<std::string, std::vector<bool>>& m_alert_list;
+    std::vector<std::unordered_map<signal_id_t, var_t>>& m_golden_trace;
+    std::vector<std::unordered_map<signal_id_t, var_t>>& m_faulty_trace;
+    std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& m_faults;
+    std::vector<std::unordered_set<signal_id_t>> m_refined_regs;
+    std::vector<std::unordered_set<signal_id_t>> m_read_regs;
+    std::vector<bool> m_refined_alerts;
+    std::unordered_map<signal_id_t, std::vector<signal_id_t>> m_next_regs;
+
+    void materialize(uint32_t cycle, signal_id_t sig);
+    void refine_reg(uint32_t cycle, signal_id_t reg);
+    void refine_alerts(uint32_t cycle);
+public:
+    AbstractUnrolling(const Circuit& circuit,
+                      std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+                      std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                      const std::unordered_set<signal_id_t>& faultable_sigs,
+                      std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults,
+                      const std::unordered_set<signal_id_t>& alert_signals,
+                      const std::unordered_map<std::string, std::vector<bool>>& invariant_list,
+                      const std::unordered_map<std::string, std::vector<bool>>& alert_list,
+                      uint32_t depth);
+    /*  Replay the model of the solver on the concrete circuit and refine where
+     *  the counterexample relies on the abstraction:
+     *  - alerts raised by the replay
+     *  - differences between golden and faulty cut registers at cycle 1 that
+     *    the replay does not show
+     *  - cut registers read by encoded cones with another value in the replay
+     *  Registers sharing a previous register with a refined one are refined
+     *  along with it. Returns the number of refinements, 0 if the counterexample is concrete
+     */
+    uint32_t refine();
+    uint32_t num_refined() const;
+};
+
+#endif // VERIFIER_CEGAR_H
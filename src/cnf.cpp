@@ -0,0 +1,346 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "cnf.h"
+
+Cnf* cnf_builder = nullptr;
+
+const lit_t lit_t::ZERO = lit_t(1);
+const lit_t lit_t::ONE = lit_t(0);
+
+lit_t lit_t::operator&(const lit_t& o) const
+{
+    if (*this == ZERO || o == ZERO || *this == !o) return ZERO;
+    if (*this == ONE || *this == o) return o;
+    if (o == ONE) return *this;
+
+    lit_t y = cnf_builder->new_var();
+    cnf_builder->add_clause({!y, *this});
+    cnf_builder->add_clause({!y, o});
+    cnf_builder->add_clause({y, !*this, !o});
+    return y;
+}
+
+lit_t lit_t::operator|(const lit_t& o) const
+{
+    return !((!*this) & (!o));
+}
+
+lit_t lit_t::operator^(const lit_t& o) const
+{
+    if (*this == ZERO) return o;
+    if (*this == ONE) return !o;
+    if (o == ZERO) return *this;
+    if (o == ONE) return !*this;
+    if (*this == o) return ZERO;
+    if (*this == !o) return ONE;
+
+    lit_t y = cnf_builder->new_var();
+    cnf_builder->add_clause({!y,  *this,  o});
+    cnf_builder->add_clause({!y, !*this, !o});
+    cnf_builder->add_clause({ y, !*this,  o});
+    cnf_builder->add_clause({ y,  *this, !o});
+    return y;
+}
+
+lit_t mux(lit_t cond, lit_t t_val, lit_t e_val)
+{
+    if (cond == lit_t::ONE || t_val == e_val) return t_val;
+    if (cond == lit_t::ZERO) return e_val;
+    if (t_val == lit_t::ONE || t_val == cond) return cond | e_val;
+    if (t_val == lit_t::ZERO || t_val == !cond) return (!cond) & e_val;
+    if (e_val == lit_t::ONE || e_val == !cond) return (!cond) | t_val;
+    if (e_val == lit_t::ZERO || e_val == cond) return cond & t_val;
+
+    lit_t y = cnf_builder->new_var();
+    cnf_builder->add_clause({!cond, !t_val,  y});
+    cnf_builder->add_clause({!cond,  t_val, !y});
+    cnf_builder->add_clause({ cond, !e_val,  y});
+    cnf_builder->add_clause({ cond,  e_val, !y});
+    // Redundant clauses helping propagation
+    cnf_builder->add_clause({!t_val, !e_val,  y});
+    cnf_builder->add_clause({ t_val,  e_val, !y});
+    return y;
+}
+
+void Cnf::add_clause(const std::vector<lit_t>& lits)
+{
+    std::vector<uint32_t> clause;
+    for (const lit_t& lit : lits)
+    {
+        if (lit == lit_t::ONE) return;
+        if (lit == lit_t::ZERO) continue;
+        if ((lit.code >> 1) >= m_num_vars) throw std::logic_error(ILLEGAL_CNF_LITERAL);
+        clause.push_back(lit.code);
+    }
+    // The empty clause is kept as the unit clause of false
+    if (clause.empty()) clause.push_back(lit_t::ZERO.code);
+
+    m_clauses.push_back(clause.size());
+    m_clauses.insert(m_clauses.end(), clause.begin(), clause.end());
+}
+
+var_t to_solver(const std::vector<var_t>& vars, lit_t lit)
+{
+    const var_t& var = vars.at(lit.code >> 1);
+    return (lit.code & 1) ? !var : var;
+}
+
+std::vector<var_t> Cnf::load_into_solver() const
+{
+    std::vector<var_t> vars;
+    vars.reserve(m_num_vars);
+    vars.push_back(var_t::ONE);
+    for (uint32_t var = 1; var < m_num_vars; var++)
+        vars.push_back(cxxsat::solver->new_var());
+
+    std::vector<var_t> clause;
+    for (size_t pos = 0; pos < m_clauses.size(); pos += 1 + m_clauses.at(pos))
+    {
+        clause.clear();
+        for (uint32_t idx = 1; idx <= m_clauses.at(pos); idx++)
+            clause.push_back(to_solver(vars, lit_t(m_clauses.at(pos + idx))));
+        add_clause_lits(clause);
+    }
+    return vars;
+}
+
+///////////   Solver primitives   //////////////////////////////////////////////
+
+template <> var_t new_var<var_t>()
+{
+    return cxxsat::solver->new_var();
+}
+
+template <> var_t make_const<var_t>(bool b)
+{
+    return cxxsat::from_bool(b);
+}
+
+template <> void add_clause_lits<var_t>(const std::vector<var_t>& lits)
+{
+    switch (lits.size())
+    {
+        case 1: cxxsat::solver->add_clause(lits[0]); break;
+        case 2: cxxsat::solver->add_clause(lits[0], lits[1]); break;
+        case 3: cxxsat::solver->add_clause(lits[0], lits[1], lits[2]); break;
+        case 4: cxxsat::solver->add_clause(lits[0], lits[1], lits[2], lits[3]); break;
+        case 5: cxxsat::solver->add_clause(lits[0], lits[1], lits[2], lits[3], lits[4]); break;
+        case 6: cxxsat::solver->add_clause(lits[0], lits[1], lits[2], lits[3], lits[4], lits[5]); break;
+        case 7: cxxsat::solver->add_clause(lits[0], lits[1], lits[2], lits[3], lits[4], lits[5], lits[6]); break;
+        default: throw std::logic_error(ILLEGAL_CLAUSE_SIZE);
+    }
+}
+
+template <> var_t make_and<var_t>(const std::vector<var_t>& ops)
+{
+    return cxxsat::solver->make_and(ops);
+}
+
+template <> lit_t new_var<lit_t>()
+{
+    return cnf_builder->new_var();
+}
+
+template <> lit_t make_const<lit_t>(bool b)
+{
+    return b ? lit_t::ONE : lit_t::ZERO;
+}
+
+template <> void add_clause_lits<lit_t>(const std::vector<lit_t>& lits)
+{
+    if (lits.empty() || lits.size() > 7) throw std::logic_error(ILLEGAL_CLAUSE_SIZE);
+    cnf_builder->add_clause(lits);
+}
+
+template <> lit_t make_and<lit_t>(const std::vector<lit_t>& ops)
+{
+    // Tree of AND nodes, keeping clauses short enough to be loaded back
+    std::vector<lit_t> level(ops);
+    while (level.size() > 1)
+    {
+        std::vector<lit_t> next;
+        for (size_t beg = 0; beg < level.size(); beg += CNF_AND_FANIN)
+        {
+            const size_t end = std::min(level.size(), beg + CNF_AND_FANIN);
+            lit_t y = cnf_builder->new_var();
+            std::vector<lit_t> ops_imply_y = {y};
+            for (size_t idx = beg; idx < end; idx++)
+            {
+                cnf_builder->add_clause({!y, level.at(idx)});
+                ops_imply_y.push_back(!level.at(idx));
+            }
+            cnf_builder->add_clause(ops_imply_y);
+            next.push_back(y);
+        }
+        level = std::move(next);
+    }
+    return level.empty() ? lit_t::ONE : level.front();
+}
+
+///////////   Cache   //////////////////////////////////////////////////////////
+
+uint64_t fnv1a(const std::string& data, uint64_t hash)
+{
+    for (const char c : data)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static void hash_signals(const std::unordered_set<signal_id_t>& sigs, uint64_t& hash)
+{
+    std::vector<signal_id_t> sorted(sigs.begin(), sigs.end());
+    std::sort(sorted.begin(), sorted.end());
+    hash = fnv1a(std::string(reinterpret_cast<const char*>(sorted.data()),
+                             sorted.size() * sizeof(signal_id_t)), hash);
+}
+
+uint64_t circuit_hash(const Circuit& circuit)
+{
+    uint64_t hash = fnv1a("");
+    hash_signals(circuit.ins(), hash);
+    hash_signals(circuit.outs(), hash);
+    hash_signals(circuit.regs(), hash);
+    // Unused ports are zeroed by the constructor of `Ports`
+    for (const Cell* cell : circuit.cells())
+    {
+        const uint32_t type = static_cast<uint32_t>(cell->type());
+        hash = fnv1a(std::string(reinterpret_cast<const char*>(&type), sizeof(type)), hash);
+        hash = fnv1a(std::string(reinterpret_cast<const char*>(&cell->ports()), sizeof(Ports)), hash);
+    }
+    return hash;
+}
+
+static void write_u32(std::ostream& os, uint32_t val)
+{
+    os.write(reinterpret_cast<const char*>(&val), sizeof(val));
+}
+
+static uint32_t read_u32(std::istream& is)
+{
+    uint32_t val = 0;
+    is.read(reinterpret_cast<char*>(&val), sizeof(val));
+    return val;
+}
+
+void Cnf::write(std::ostream& os) const
+{
+    write_u32(os, m_num_vars);
+    write_u32(os, m_clauses.size());
+    os.write(reinterpret_cast<const char*>(m_clauses.data()), m_clauses.size() * sizeof(uint32_t));
+}
+
+bool Cnf::read(std::istream& is)
+{
+    m_num_vars = read_u32(is);
+    m_clauses.resize(read_u32(is));
+    is.read(reinterpret_cast<char*>(m_clauses.data()), m_clauses.size() * sizeof(uint32_t));
+    if (!is.good() || m_num_vars == 0) return false;
+
+    // Reject truncated clauses and unknown variables
+    for (size_t pos = 0; pos < m_clauses.size(); pos += 1 + m_clauses.at(pos))
+    {
+        if (m_clauses.at(pos) == 0 || pos + m_clauses.at(pos) >= m_clauses.size()) return false;
+        for (uint32_t idx = 1; idx <= m_clauses.at(pos); idx++)
+            if ((m_clauses.at(pos + idx) >> 1) >= m_num_vars) return false;
+    }
+    return true;
+}
+
+static void write_trace(std::ostream& os, const std::vector<std::unordered_map<signal_id_t, lit_t>>& trace)
+{
+    write_u32(os, trace.size());
+    for (const auto& state : trace)
+    {
+        write_u32(os, state.size());
+        for (const auto& it : state)
+        {
+            write_u32(os, static_cast<uint32_t>(it.first));
+            write_u32(os, it.second.code);
+        }
+    }
+}
+
+static bool read_trace(std::istream& is, uint32_t num_vars,
+                       std::vector<std::unordered_map<signal_id_t, lit_t>>& trace)
+{
+    trace.resize(read_u32(is));
+    for (auto& state : trace)
+    {
+        const uint32_t size = read_u32(is);
+        if (!is.good()) return false;
+        for (uint32_t idx = 0; idx < size; idx++)
+        {
+            const signal_id_t sig = static_cast<signal_id_t>(read_u32(is));
+            const lit_t lit(read_u32(is));
+            if ((lit.code >> 1) >= num_vars) return false;
+            state.emplace(sig, lit);
+        }
+    }
+    return is.good();
+}
+
+// Header of cache files
+static const std::string CNF_CACHE_MAGIC = "k-partitions cnf";
+
+void save_cnf_unrolling(const std::string& file_name, const std::string& key,
+                        const cnf_unrolling_t& unrolling)
+{
+    // Write then rename, so that concurrent runs never read a partial file.
+    // Each process writes its own temporary file
+    const std::string tmp_name = file_name + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream os(tmp_name, std::ios::binary);
+        os.write(CNF_CACHE_MAGIC.data(), CNF_CACHE_MAGIC.size());
+        write_u32(os, CNF_CACHE_VERSION);
+        write_u32(os, key.size());
+        os.write(key.data(), key.size());
+        unrolling.cnf.write(os);
+        write_trace(os, unrolling.golden_trace);
+        write_trace(os, unrolling.faulty_trace);
+        write_trace(os, unrolling.faults);
+    }
+    std::filesystem::rename(tmp_name, file_name);
+}
+
+bool load_cnf_unrolling(const std::string& file_name, const std::string& key,
+                        cnf_unrolling_t& unrolling)
+{
+    std::ifstream is(file_name, std::ios::binary);
+    if (!is.good()) return false;
+
+    std::string magic(CNF_CACHE_MAGIC.size(), '\0');
+    is.read(magic.data(), magic.size());
+    if (magic != CNF_CACHE_MAGIC || read_u32(is) != CNF_CACHE_VERSION) return false;
+
+    std::string file_key(read_u32(is), '\0');
+    if (!is.good() || file_key.size() != key.size()) return false;
+    is.read(file_key.data(), file_key.size());
+    if (file_key != key) return false;
+
+    return unrolling.cnf.read(is) &&
+           read_trace(is, unrolling.cnf.num_vars(), unrolling.golden_trace) &&
+           read_trace(is, unrolling.cnf.num_vars(), unrolling.faulty_trace) &&
+           read_trace(is, unrolling.cnf.num_vars(), unrolling.faults);
+}
@@ -0,0 +1,136 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_CNF_H
+#define VERIFIER_CNF_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Circuit.h"
+#include "vars.h"
+#include "Solver.h"
+
+using var_t = cxxsat::var_t;
+
+constexpr const char* ILLEGAL_CLAUSE_SIZE = "Clause exceeds the maximal supported size";
+constexpr const char* ILLEGAL_CNF_LITERAL = "Literal does not belong to the CNF";
+
+// Version of the binary format of cached CNFs, to bump on every change of the
+// format or of the encodings
+#define CNF_CACHE_VERSION 1
+
+///////////   Lit_t   //////////////////////////////////////////////////////////
+// A literal of the CNF in `cnf_builder`: variable `code >> 1`, negated if the
+// lowest bit is set. Variable 0 is the constant true. Gates are folded with
+// constants and complemented operands before being encoded with Tseitin
+
+struct lit_t
+{
+    uint32_t code;
+    static const lit_t ZERO;
+    static const lit_t ONE;
+    constexpr lit_t() : code(1) {}
+    constexpr explicit lit_t(uint32_t c) : code(c) {}
+    lit_t operator!() const { return lit_t(code ^ 1); }
+    lit_t operator-() const { return lit_t(code ^ 1); }
+    lit_t operator+() const { return *this; }
+    lit_t operator&(const lit_t& o) const;
+    lit_t operator|(const lit_t& o) const;
+    lit_t operator^(const lit_t& o) const;
+    bool operator==(const lit_t& o) const { return code == o.code; }
+    bool operator!=(const lit_t& o) const { return code != o.code; }
+};
+
+lit_t mux(lit_t cond, lit_t t_val, lit_t e_val);
+
+class Cnf
+{
+protected:
+    uint32_t m_num_vars;
+    // Clauses stored one after the other, each one prefixed by its size
+    std::vector<uint32_t> m_clauses;
+public:
+    Cnf() : m_num_vars(1) {}
+    uint32_t num_vars() const { return m_num_vars; }
+    const std::vector<uint32_t>& clauses() const { return m_clauses; }
+    lit_t new_var() { return lit_t(2 * m_num_vars++); }
+    // Add a clause, dropping false literals and satisfied clauses
+    void add_clause(const std::vector<lit_t>& lits);
+    /*  Create the variables and add the clauses in the solver.
+     *  Returns the solver literal of every variable of the CNF
+     */
+    std::vector<var_t> load_into_solver() const;
+    void write(std::ostream& os) const;
+    bool read(std::istream& is);
+};
+
+extern Cnf* cnf_builder;
+
+var_t to_solver(const std::vector<var_t>& vars, lit_t lit);
+
+///////////   Solver primitives   //////////////////////////////////////////////
+// Building blocks of the encodings, either in the solver (var_t) or in
+// `cnf_builder` (lit_t)
+
+template <typename V> V new_var();
+template <typename V> V make_const(bool b);
+// Add a clause of up to 7 literals
+template <typename V> void add_clause_lits(const std::vector<V>& lits);
+template <typename V> V make_and(const std::vector<V>& ops);
+
+template <> var_t new_var<var_t>();
+template <> var_t make_const<var_t>(bool b);
+template <> void add_clause_lits<var_t>(const std::vector<var_t>& lits);
+template <> var_t make_and<var_t>(const std::vector<var_t>& ops);
+
+template <> lit_t new_var<lit_t>();
+template <> lit_t make_const<lit_t>(bool b);
+template <> void add_clause_lits<lit_t>(const std::vector<lit_t>& lits);
+template <> lit_t make_and<lit_t>(const std::vector<lit_t>& ops);
+
+// Maximal number of operands of an AND node of the CNF
+#define CNF_AND_FANIN 6
+
+///////////   Cnf_unrolling_t   ////////////////////////////////////////////////
+// Unrolled golden/faulty traces encoded in a CNF, together with the literal of
+// every signal per clock cycle and of every fault site
+
+struct cnf_unrolling_t
+{
+    Cnf cnf;
+    std::vector<std::unordered_map<signal_id_t, lit_t>> golden_trace;
+    std::vector<std::unordered_map<signal_id_t, lit_t>> faulty_trace;
+    std::vector<std::unordered_map<signal_id_t, lit_t>> faults;
+};
+
+// Stable 64-bit FNV-1a hash
+uint64_t fnv1a(const std::string& data, uint64_t hash = 0xcbf29ce484222325ULL);
+
+// Hash of the cells and ports of the circuit
+uint64_t circuit_hash(const Circuit& circuit);
+
+/*  Save/load an unrolling to/from `file_name`. Loading fails if the file does
+ *  not exist, has another version or was saved with another key
+ */
+void save_cnf_unrolling(const std::string& file_name, const std::string& key,
+                        const cnf_unrolling_t& unrolling);
+bool load_cnf_unrolling(const std::string& file_name, const std::string& key,
+                        cnf_unrolling_t& unrolling);
+
+#endif // VERIFIER_CNF_H
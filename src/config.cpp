@@ -18,8 +18,8 @@ constexpr const char* MISSING_PARAM = "Missing parameter in configuration file";
 constexpr const char* MISSING_CONF = "Missing configuration in file";
 
 
-config_t::config_t( std::string config_file,
-                    std::string config_name)
+nlohmann::json config_json(const std::string& config_file, const std::string& config_name,
+                           const nlohmann::json& overrides)
 {
     std::ifstream f; f.exceptions(std::ifstream::badbit);
     f.open(config_file);
@@ -31,6 +31,17 @@ config_t::config_t( std::string config_file,
         throw std::logic_error(MISSING_CONF);
 
     auto jdata = pdata.at(config_name);
+    for (const auto& it : overrides.items())
+        jdata[it.key()] = it.value();
+    return jdata;
+}
+
+config_t::config_t( std::string config_file,
+                    std::string config_name,
+                    bool reset_dump,
+                    const nlohmann::json& overrides)
+{
+    auto jdata = config_json(config_file, config_name, overrides);
 
     try {
         design_path = jdata.at("design_path");
@@ -123,6 +134,91 @@ config_t::config_t( std::string config_file,
         { optim_atleast2 = jdata.at("optim_atleast2"); }
     else optim_atleast2 = true ;
 
+    if (jdata.contains("optim_xor"))
+        { optim_xor = jdata.at("optim_xor"); }
+    else optim_xor = false ;
+
+    if (jdata.contains("optim_odc"))
+        { optim_odc = jdata.at("optim_odc"); }
+    else optim_odc = false ;
+
+    if (jdata.contains("optim_sweep"))
+        { optim_sweep = jdata.at("optim_sweep"); }
+    else optim_sweep = false ;
+
+    if (jdata.contains("optim_delta"))
+        { optim_delta = jdata.at("optim_delta"); }
+    else optim_delta = false ;
+
+    if (jdata.contains("cut_size"))
+        { cut_size = jdata.at("cut_size"); }
+    else cut_size = 0 ;
+
+    if (jdata.contains("incremental_unroll"))
+        { incremental_unroll = jdata.at("incremental_unroll"); }
+    else incremental_unroll = false ;
+
+    if (jdata.contains("cnf_cache_path"))
+        { cnf_cache_path = jdata.at("cnf_cache_path"); }
+    else cnf_cache_path = "" ;
+
+    if (jdata.contains("mine_invariants"))
+        { mine_invariants = jdata.at("mine_invariants"); }
+    else mine_invariants = 0 ;
+
+    if (jdata.contains("cegar"))
+        { cegar = jdata.at("cegar"); }
+    else cegar = false ;
+
+    if (jdata.contains("bdd_width"))
+        { bdd_width = jdata.at("bdd_width"); }
+    else bdd_width = 0 ;
+
+    if (jdata.contains("portfolio"))
+        { portfolio = jdata.at("portfolio"); }
+    else portfolio = 0 ;
+
+    if (jdata.contains("parallel_splits"))
+        { parallel_splits = jdata.at("parallel_splits"); }
+    else parallel_splits = 0 ;
+
+    if (jdata.contains("query_timeout"))
+        { query_timeout = jdata.at("query_timeout"); }
+    else query_timeout = 0 ;
+
+    if (jdata.contains("warm_start"))
+        { warm_start = jdata.at("warm_start"); }
+    else warm_start = false ;
+
+    if (jdata.contains("enumerate_minimal"))
+        { enumerate_minimal = jdata.at("enumerate_minimal"); }
+    else enumerate_minimal = false ;
+
+    if (jdata.contains("cube_after"))
+        { cube_after = jdata.at("cube_after"); }
+    else cube_after = 0 ;
+
+    if (jdata.contains("cube_regions"))
+        { cube_regions = jdata.at("cube_regions"); }
+    else cube_regions = 8 ;
+
+    if (jdata.contains("work_queue"))
+        { work_queue = jdata.at("work_queue"); }
+
+    if (jdata.contains("speculative"))
+        { speculative = jdata.at("speculative"); }
+    else speculative = 0 ;
+
+    if (jdata.contains("sat_backend"))
+        { sat_backend = jdata.at("sat_backend"); }
+
+    if (jdata.contains("result_cache_path"))
+        { result_cache_path = jdata.at("result_cache_path"); }
+
+    if (jdata.contains("pipeline_proc2"))
+        { pipeline_proc2 = jdata.at("pipeline_proc2"); }
+    else pipeline_proc2 = false ;
+
     if (jdata.contains("dump_vcd"))
         { dump_vcd = jdata.at("dump_vcd"); }
     else dump_vcd = false ;
@@ -149,6 +245,12 @@ config_t::config_t( std::string config_file,
     }
 
 
+    // Workers of a work queue share the dump folder of their coordinator
+    if (!reset_dump) {
+        std::filesystem::create_directories(dump_path);
+        return;
+    }
+
     if (std::filesystem::exists(dump_path)) {
         std::filesystem::remove_all(dump_path);
         // throw std::runtime_error("Output folder `" + dump_path + "` already exists");
@@ -156,4 +258,8 @@ config_t::config_t( std::string config_file,
 
     std::filesystem::create_directories(dump_path);
     std::filesystem::copy_file(config_file, dump_path+"/config_file");
+    if (!overrides.empty()) {
+        std::ofstream f_overrides(dump_path + "/overrides");
+        f_overrides << overrides.dump(1) << std::endl;
+    }
 }
@@ -60,12 +60,40 @@ struct config_t
     std::string dump_path;
     bool enumerate_exploitable;
     bool optim_atleast2;
+    bool optim_xor;
+    bool optim_odc;
+    bool optim_sweep;
+    bool optim_delta;
+    uint32_t cut_size;
+    bool incremental_unroll;
+    std::string cnf_cache_path;
+    uint32_t mine_invariants;
+    bool cegar;
+    uint32_t bdd_width;
+    uint32_t portfolio;
+    uint32_t parallel_splits;
+    uint32_t query_timeout;
+    bool warm_start;
+    bool enumerate_minimal;
+    uint32_t cube_after;
+    uint32_t cube_regions;
+    std::string work_queue;
+    uint32_t speculative;
+    std::string sat_backend;
+    std::string result_cache_path;
+    bool pipeline_proc2;
     bool dump_vcd;
     bool dump_partitioning;
     std::vector<std::string> interesting_names;
     
-    config_t(std::string config_file, std::string config_name);
+    config_t(std::string config_file, std::string config_name, bool reset_dump = true,
+             const nlohmann::json& overrides = nlohmann::json::object());
 };
 
+// Configuration `config_name` of `config_file`, with the keys of `overrides`
+// replacing its own
+nlohmann::json config_json(const std::string& config_file, const std::string& config_name,
+                           const nlohmann::json& overrides = nlohmann::json::object());
+
 
 #endif // VERIFIER_CONFIG_H
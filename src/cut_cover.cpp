@@ -0,0 +1,305 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "cut_cover.h"
+#include "Simulator.h"
+#include "utils.h"
+
+cut_cover_t compute_cut_cover(const Circuit& circuit, uint32_t cut_size,
+                              const std::unordered_set<signal_id_t>& kept_sigs,
+                              const std::unordered_set<signal_id_t>& excluded_sigs)
+{
+    if (cut_size < 2 || cut_size > 6) throw std::logic_error(ILLEGAL_CUT_SIZE);
+
+    // Combinational gates that may be absorbed in a cut
+    std::unordered_map<signal_id_t, const Cell*> mappable;
+    for (const Cell* cell : circuit.cells())
+    {
+        if (is_register(cell->type())) continue;
+        const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+        if (excluded_sigs.find(out_y) == excluded_sigs.end()) mappable.emplace(out_y, cell);
+    }
+
+    // Cuts stop at signals that are materialized anyway
+    auto is_boundary = [&](signal_id_t sig)
+    {
+        return mappable.find(sig) == mappable.end() || kept_sigs.find(sig) != kept_sigs.end();
+    };
+
+    auto fanout = [&](signal_id_t sig)
+    {
+        uint32_t num = circuit.get_fanout(sig).size() + circuit.outs().count(sig);
+        return std::max(num, 1U);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    //      Priority cut enumeration, in topological order
+    ////////////////////////////////////////////////////////////////////////////
+    // Cuts of a gate merge one cut of each of its inputs, an input being
+    // either a leaf or expanded with one of its own cuts. Cuts are ranked by
+    // area flow, i.e. the number of materialized gates they require, shared
+    // among the readers of each leaf
+
+    using leaves_t = std::vector<signal_id_t>;
+    std::unordered_map<signal_id_t, std::vector<leaves_t>> cuts;
+    std::unordered_map<signal_id_t, double> flows;
+
+    auto flow_of = [&](const leaves_t& leaves)
+    {
+        double flow = 1.0;
+        for (signal_id_t leaf : leaves)
+        {
+            if (!is_boundary(leaf)) flow += flows.at(leaf) / fanout(leaf);
+        }
+        return flow;
+    };
+
+    for (const Cell* cell : circuit.cells())
+    {
+        if (is_register(cell->type())) continue;
+        const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+        if (mappable.find(out_y) == mappable.end()) continue;
+
+        std::vector<leaves_t> merged = {{}};
+        for (signal_id_t in : cell_inputs(cell))
+        {
+            std::vector<leaves_t> choices;
+            if (is_constant(in)) choices.push_back({});
+            else choices.push_back({in});
+            if (!is_boundary(in))
+                choices.insert(choices.end(), cuts.at(in).begin(), cuts.at(in).end());
+
+            std::vector<leaves_t> next;
+            for (const leaves_t& partial : merged)
+            {
+                for (const leaves_t& choice : choices)
+                {
+                    leaves_t leaves;
+                    std::set_union(partial.begin(), partial.end(), choice.begin(), choice.end(),
+                                   std::back_inserter(leaves));
+                    if (leaves.size() <= cut_size) next.push_back(leaves);
+                }
+            }
+            merged = std::move(next);
+        }
+
+        std::sort(merged.begin(), merged.end());
+        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+        std::vector<std::pair<double, leaves_t>> ranked;
+        for (leaves_t& leaves : merged) ranked.emplace_back(flow_of(leaves), std::move(leaves));
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b)
+            { return a.first < b.first || (a.first == b.first && a.second.size() < b.second.size()); });
+        if (ranked.size() > CUT_PRIORITY) ranked.resize(CUT_PRIORITY);
+
+        // The cut made of the gate inputs always fits
+        assert(!ranked.empty());
+        flows.emplace(out_y, ranked.front().first);
+        auto& node_cuts = cuts[out_y];
+        for (auto& it : ranked) node_cuts.push_back(std::move(it.second));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    //      Cover selection
+    ////////////////////////////////////////////////////////////////////////////
+    // Materialize signals read by registers, by excluded gates and kept
+    // signals with their best cut, then the leaves of the selected cuts
+
+    std::vector<signal_id_t> to_visit;
+    for (const Cell* cell : circuit.cells())
+    {
+        const bool is_mapped = !is_register(cell->type()) &&
+                               mappable.find(cell->ports().m_unr.m_out_y) != mappable.end();
+        if (is_mapped) continue;
+        for (signal_id_t in : cell_inputs(cell)) to_visit.push_back(in);
+    }
+    to_visit.insert(to_visit.end(), kept_sigs.begin(), kept_sigs.end());
+    to_visit.insert(to_visit.end(), circuit.outs().begin(), circuit.outs().end());
+
+    Simulator simulator(circuit);
+    cut_cover_t cut_cover;
+    std::unordered_set<signal_id_t> materialized;
+    while (!to_visit.empty())
+    {
+        const signal_id_t sig = to_visit.back();
+        to_visit.pop_back();
+        const auto& f = mappable.find(sig);
+        if (f == mappable.end() || !materialized.emplace(sig).second) continue;
+
+        const leaves_t& best = cuts.at(sig).front();
+        for (signal_id_t leaf : best) to_visit.push_back(leaf);
+
+        // Gates whose best cut is their own inputs keep their usual encoding
+        leaves_t own_inputs;
+        for (signal_id_t in : cell_inputs(f->second))
+        {
+            if (!is_constant(in)) own_inputs.push_back(in);
+        }
+        std::sort(own_inputs.begin(), own_inputs.end());
+        own_inputs.erase(std::unique(own_inputs.begin(), own_inputs.end()), own_inputs.end());
+        if (own_inputs == best) continue;
+
+        cut_cover.luts.emplace(sig, lut_t{best, simulator.truth_table(sig, best)});
+    }
+
+    for (const auto& it : mappable)
+    {
+        if (materialized.find(it.first) == materialized.end())
+            cut_cover.absorbed.emplace(it.first);
+    }
+
+    return cut_cover;
+}
+
+std::stringstream cut_cover_info(const cut_cover_t& cut_cover)
+{
+    std::stringstream ss;
+    std::array<uint32_t, 7> by_size = {0};
+    for (const auto& it : cut_cover.luts) by_size.at(it.second.leaves.size())++;
+
+    ss << "******* Cut cover ********" << std::endl;
+    ss << "LUTs: " << cut_cover.luts.size() << " (by size:";
+    for (uint32_t size = 1; size < by_size.size(); size++) ss << " " << by_size.at(size);
+    ss << ")" << std::endl;
+    ss << "Absorbed gates: " << cut_cover.absorbed.size() << std::endl;
+    return ss;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//      LUT encoding
+////////////////////////////////////////////////////////////////////////////////
+
+struct cube_t
+{
+    uint8_t pos;
+    uint8_t neg;
+};
+
+static uint64_t cofactor0(uint64_t tt, uint32_t var)
+{
+    const uint64_t low = tt & ~TT_VAR[var];
+    return low | (low << (1U << var));
+}
+
+static uint64_t cofactor1(uint64_t tt, uint32_t var)
+{
+    const uint64_t high = tt & TT_VAR[var];
+    return high | (high >> (1U << var));
+}
+
+static bool depends_on(uint64_t tt, uint32_t var)
+{
+    return cofactor0(tt, var) != cofactor1(tt, var);
+}
+
+// Minato-Morreale irredundant sum of products of a function lying between
+// `on` and `on_dc`, over its first `num_vars` variables. Returns the cover
+static uint64_t isop(uint64_t on, uint64_t on_dc, int num_vars, std::vector<cube_t>& cubes)
+{
+    if (on == 0) return 0;
+    if (on_dc == ~0ULL) { cubes.push_back({0, 0}); return ~0ULL; }
+
+    int var = num_vars - 1;
+    while (var >= 0 && !depends_on(on, var) && !depends_on(on_dc, var)) var--;
+    assert(var >= 0);
+
+    const uint64_t on0 = cofactor0(on, var), on1 = cofactor1(on, var);
+    const uint64_t dc0 = cofactor0(on_dc, var), dc1 = cofactor1(on_dc, var);
+
+    const size_t beg0 = cubes.size();
+    const uint64_t res0 = isop(on0 & ~dc1, dc0, var, cubes);
+    const size_t beg1 = cubes.size();
+    const uint64_t res1 = isop(on1 & ~dc0, dc1, var, cubes);
+    const size_t beg2 = cubes.size();
+    const uint64_t res2 = isop((on0 & ~res0) | (on1 & ~res1), dc0 & dc1, var, cubes);
+
+    for (size_t idx = beg0; idx < beg1; idx++) cubes.at(idx).neg |= (1U << var);
+    for (size_t idx = beg1; idx < beg2; idx++) cubes.at(idx).pos |= (1U << var);
+    return (res0 & ~TT_VAR[var]) | (res1 & TT_VAR[var]) | res2;
+}
+
+// Add the clauses `cube -> y` for every cube of the cover
+template <typename V>
+static void add_cover_clauses(const std::vector<V>& leaves, const std::vector<cube_t>& cubes,
+                              const V& y)
+{
+    for (const cube_t& cube : cubes)
+    {
+        std::vector<V> lits;
+        for (uint32_t var = 0; var < leaves.size(); var++)
+        {
+            if ((cube.pos >> var) & 1) lits.push_back(!leaves.at(var));
+            if ((cube.neg >> var) & 1) lits.push_back(leaves.at(var));
+        }
+        lits.push_back(y);
+        add_clause_lits(lits);
+    }
+}
+
+template <typename V>
+V make_lut(const std::vector<V>& leaves, uint64_t truth_table)
+{
+    assert(leaves.size() <= 6);
+
+    // Fold constant leaves and merge (possibly complemented) duplicated ones
+    std::vector<bool> live(leaves.size(), true);
+    for (uint32_t var = 0; var < leaves.size(); var++)
+    {
+        const V& leaf = leaves.at(var);
+        const uint64_t tt0 = cofactor0(truth_table, var);
+        const uint64_t tt1 = cofactor1(truth_table, var);
+
+        if (leaf == V::ONE || leaf == V::ZERO) {
+            truth_table = (leaf == V::ONE) ? tt1 : tt0;
+            live.at(var) = false;
+            continue;
+        }
+        for (uint32_t other = 0; other < var; other++)
+        {
+            if (!live.at(other)) continue;
+            if (leaves.at(other) == leaf) {
+                truth_table = (tt1 & TT_VAR[other]) | (tt0 & ~TT_VAR[other]);
+            } else if (leaves.at(other) == !leaf) {
+                truth_table = (tt0 & TT_VAR[other]) | (tt1 & ~TT_VAR[other]);
+            } else continue;
+            live.at(var) = false;
+            break;
+        }
+    }
+
+    if (truth_table == 0) return V::ZERO;
+    if (truth_table == ~0ULL) return V::ONE;
+
+    // Buffers and inverters of a single leaf
+    for (uint32_t var = 0; var < leaves.size(); var++)
+    {
+        if (truth_table == TT_VAR[var]) return leaves.at(var);
+        if (truth_table == ~TT_VAR[var]) return !leaves.at(var);
+    }
+
+    std::vector<cube_t> on_cubes, off_cubes;
+    isop(truth_table, truth_table, leaves.size(), on_cubes);
+    isop(~truth_table, ~truth_table, leaves.size(), off_cubes);
+
+    V y = new_var<V>();
+    add_cover_clauses(leaves, on_cubes, y);
+    add_cover_clauses(leaves, off_cubes, !y);
+    return y;
+}
+
+template var_t make_lut<var_t>(const std::vector<var_t>& leaves, uint64_t truth_table);
+template lit_t make_lut<lit_t>(const std::vector<lit_t>& leaves, uint64_t truth_table);
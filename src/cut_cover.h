@@ -0,0 +1,67 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_CUT_COVER_H
+#define VERIFIER_CUT_COVER_H
+
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Circuit.h"
+#include "vars.h"
+#include "Solver.h"
+
+using var_t = cxxsat::var_t;
+
+constexpr const char* ILLEGAL_CUT_SIZE = "Cut size must be between 2 and 6";
+
+// Maximal number of cuts kept per signal during the enumeration
+#define CUT_PRIORITY 8
+
+///////////   Lut_t   //////////////////////////////////////////////////////////
+// A signal computed from at most 6 leaves, the i-th leaf being the i-th
+// variable of its truth table. Gates strictly inside the cut are absorbed
+
+struct lut_t
+{
+    std::vector<signal_id_t> leaves;
+    uint64_t truth_table;
+};
+
+struct cut_cover_t
+{
+    std::unordered_map<signal_id_t, lut_t> luts;
+    std::unordered_set<signal_id_t> absorbed;
+};
+
+/*  Cover the combinational logic with k-feasible cuts selected by area flow.
+ *  Signals in `kept_sigs` are always materialized (fault sites, outputs, ...)
+ *  and signals in `excluded_sigs` are left to other encodings
+ */
+cut_cover_t compute_cut_cover(const Circuit& circuit, uint32_t cut_size,
+                              const std::unordered_set<signal_id_t>& kept_sigs,
+                              const std::unordered_set<signal_id_t>& excluded_sigs);
+
+std::stringstream cut_cover_info(const cut_cover_t& cut_cover);
+
+/*  Encode the function `truth_table` of `leaves`.
+ *  Constant and duplicated leaves are simplified, the on-set and off-set are
+ *  encoded with the clauses of their irredundant sums of products
+ */
+template <typename V>
+V make_lut(const std::vector<V>& leaves, uint64_t truth_table);
+
+#endif // VERIFIER_CUT_COVER_H
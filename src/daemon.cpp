@@ -0,0 +1,225 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "daemon.h"
+#include "config.h"
+#include "parallel.h"
+
+static sockaddr_un socket_address(const std::string& socket_path, const char* error)
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) throw std::logic_error(error);
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+// Fails when the client left, without raising SIGPIPE
+static bool send_all(int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        const ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+static std::string receive_line(int fd)
+{
+    std::string line;
+    char c;
+    while (read(fd, &c, 1) == 1 && c != '\n') line.push_back(c);
+    return line;
+}
+
+/*  Run a request in a forked process and stream its log to the client until
+ *  it exits. A client leaving kills the request
+ */
+static bool serve_request(int fd, const std::string& config_name, const nlohmann::json& overrides,
+                          const std::string& log_name, Circuit* design, const daemon_run_t& run)
+{
+    // The log of a previous run must not be taken for the new one
+    std::error_code ec;
+    std::filesystem::remove(log_name, ec);
+
+    const pid_t pid = fork();
+    if (pid < 0) throw std::logic_error(ILLEGAL_FORK);
+    if (pid == 0) {
+        close(fd);
+        int status = 1;
+        try {
+            run(config_name, overrides, design);
+            status = 0;
+        } catch (const std::exception& e) {
+            std::cerr << config_name << ": " << e.what() << std::endl;
+        }
+        _exit(status);
+    }
+
+    std::ifstream log;
+    char buffer[4096];
+    bool client = true;
+    int status = 0;
+    for (;;)
+    {
+        const pid_t done = waitpid(pid, &status, WNOHANG);
+        if (done < 0 && errno != EINTR) throw std::logic_error(ILLEGAL_WORKER_EXIT);
+
+        if (!log.is_open() && std::filesystem::exists(log_name)) log.open(log_name);
+        while (log.is_open() && client)
+        {
+            log.read(buffer, sizeof(buffer));
+            const std::streamsize n = log.gcount();
+            log.clear();
+            if (n == 0) break;
+            client = send_all(fd, std::string(buffer, n));
+        }
+        if (!client && done == 0) kill(pid, SIGKILL);
+
+        if (done == pid) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(DAEMON_POLL_MS));
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void run_daemon(const std::string& socket_path, const std::string& config_file,
+                const std::string& cache_dir, const daemon_run_t& run, std::ostream& out)
+{
+    const sockaddr_un addr = socket_address(socket_path, ILLEGAL_DAEMON_SOCKET);
+    const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socket_path.c_str());
+    if (server < 0 || bind(server, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(server, 16) != 0)
+        throw std::logic_error(ILLEGAL_DAEMON_SOCKET);
+    out << "Listening on `" << socket_path << "`" << std::endl;
+
+    // Designs stay resident with their adjacency lists
+    std::map<std::string, Circuit*> designs;
+
+    for (bool stop = false; !stop;)
+    {
+        const int fd = accept(server, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            throw std::logic_error(ILLEGAL_DAEMON_SOCKET);
+        }
+
+        std::string config_name;
+        const auto start{std::chrono::steady_clock::now()};
+        try {
+            const nlohmann::json request = nlohmann::json::parse(receive_line(fd));
+            if (request.value("stop", false)) {
+                send_all(fd, "Stopping\n");
+                stop = true;
+            } else {
+                config_name = request.at("config");
+                nlohmann::json overrides = request.value("overrides", nlohmann::json::object());
+                nlohmann::json jdata = config_json(config_file, config_name, overrides);
+                if (!cache_dir.empty()) {
+                    if (!jdata.contains("cnf_cache_path")) overrides["cnf_cache_path"] = cache_dir + "/cnf";
+                    if (!jdata.contains("result_cache_path")) overrides["result_cache_path"] = cache_dir + "/results";
+                }
+
+                const std::string design_path = jdata.at("design_path");
+                const std::string design_name = jdata.at("design_name");
+                Circuit*& design = designs[design_path + ":" + design_name];
+                if (design == nullptr) {
+                    const auto start_parse{std::chrono::steady_clock::now()};
+                    std::unique_ptr<Circuit> parsed = std::make_unique<Circuit>(design_path, design_name);
+                    parsed->build_adjacent_lists();
+                    design = parsed.release();
+                    uint32_t parse_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start_parse).count();
+                    out << "Parsed design `" << design_name << "` of `" << design_path << "` in ";
+                    out << parse_ms / 1000 << "." << (parse_ms % 1000) << " s" << std::endl;
+                }
+
+                out << "Start `" << config_name << "` " << overrides.dump() << std::endl;
+                const std::string dump_path = jdata.at("dump_path");
+                const bool ok = serve_request(fd, config_name, overrides, dump_path + "/log", design, run);
+
+                uint32_t request_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+                std::stringstream done;
+                done << "Done `" << config_name << "`: " << (ok ? "ok" : "FAILED");
+                done << " in " << request_ms / 1000 << "." << (request_ms % 1000) << " s" << std::endl;
+                send_all(fd, done.str());
+                out << done.str() << std::flush;
+            }
+        } catch (const std::exception& e) {
+            send_all(fd, std::string("Error: ") + e.what() + "\n");
+            out << "Request `" << config_name << "` rejected: " << e.what() << std::endl;
+        }
+        close(fd);
+    }
+
+    for (const auto& it : designs) delete it.second;
+    close(server);
+    unlink(socket_path.c_str());
+}
+
+bool send_request(const std::string& socket_path, const nlohmann::json& request, std::ostream& out)
+{
+    const sockaddr_un addr = socket_address(socket_path, ILLEGAL_DAEMON_CONNECT);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+        throw std::logic_error(ILLEGAL_DAEMON_CONNECT);
+    send_all(fd, request.dump() + "\n");
+
+    // The last line tells whether the request succeeded
+    std::string last_line, line;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR))
+    {
+        out.write(buffer, std::max(n, ssize_t(0)));
+        for (ssize_t idx = 0; idx < n; idx++)
+        {
+            if (buffer[idx] != '\n') {
+                line.push_back(buffer[idx]);
+            } else {
+                last_line = line;
+                line.clear();
+            }
+        }
+    }
+    out << std::flush;
+    close(fd);
+    if (last_line == "Stopping") return true;
+    return last_line.rfind("Done", 0) == 0 && last_line.find("`: ok in ") != std::string::npos;
+}
@@ -0,0 +1,56 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_DAEMON_H
+#define VERIFIER_DAEMON_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+
+#include "Circuit.h"
+#include "json.hpp"
+
+constexpr const char* ILLEGAL_DAEMON_SOCKET = "Cannot listen on the daemon socket";
+constexpr const char* ILLEGAL_DAEMON_CONNECT = "Cannot connect to the daemon socket";
+
+// Delay between two looks at the log of a running request
+#define DAEMON_POLL_MS 100
+
+// Check of a configuration with its overrides on its resident design, run in
+// a forked process
+using daemon_run_t = std::function<void(const std::string&, const nlohmann::json&, Circuit*)>;
+
+/*  Serve analysis requests on the Unix socket `socket_path`, one at a time.
+ *  A request is a line of JSON:
+ *    {"config": <name>, "overrides": {<key>: <value>, ...}}
+ *  naming a configuration of `config_file` and the keys replacing its own.
+ *  The daemon keeps every design it parsed, with its adjacency lists, and runs
+ *  each request in a forked process sharing them copy-on-write. The log of the
+ *  request is streamed back while it runs, followed by a last line
+ *    Done `<name>`: ok|FAILED in <time> s
+ *  When `cache_dir` is set, requests without `cnf_cache_path` and
+ *  `result_cache_path` share its `cnf` and `results` folders on disk. Each
+ *  request still builds its own solver: no encoding stays resident between
+ *  requests, and only the files cached by the earlier ones are reused.
+ *  The request {"stop": true} stops the daemon. Progress is logged to `out`
+ */
+void run_daemon(const std::string& socket_path, const std::string& config_file,
+                const std::string& cache_dir, const daemon_run_t& run, std::ostream& out);
+
+// Send a request to the daemon and copy its answer to `out`, returns whether
+// the request succeeded
+bool send_request(const std::string& socket_path, const nlohmann::json& request, std::ostream& out);
+
+#endif // VERIFIER_DAEMON_H
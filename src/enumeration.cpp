@@ -0,0 +1,96 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+
+#include "enumeration.h"
+#include "cnf.h"
+#include "utils.h"
+
+// Projection literals outside of `allowed` are forced false
+static std::vector<var_t> forbid_others(const std::vector<var_t>& projection,
+                                        const std::vector<uint32_t>& allowed)
+{
+    std::vector<bool> is_allowed(projection.size(), false);
+    for (const uint32_t idx : allowed) is_allowed.at(idx) = true;
+
+    std::vector<var_t> extra;
+    for (uint32_t idx = 0; idx < projection.size(); idx++)
+    {
+        if (!is_allowed.at(idx)) extra.push_back(!projection.at(idx));
+    }
+    return extra;
+}
+
+enumeration_t enumerate_minimal_sets(const std::vector<var_t>& projection,
+                                     const enum_check_t& check,
+                                     const enum_report_t& report)
+{
+    enumeration_t enumeration;
+
+    while (true)
+    {
+        enumeration.checks++;
+        const cxxsat::Solver::state_t res = check({});
+        if (res != cxxsat::Solver::state_t::STATE_SAT) {
+            enumeration.complete = res == cxxsat::Solver::state_t::STATE_UNSAT;
+            break;
+        }
+
+        // Forcing more literals false only removes solutions: a literal
+        // that could not be dropped stays necessary in smaller sets
+        std::vector<uint32_t> candidates = model_t(projection).true_indexes(0, projection.size());
+        std::vector<uint32_t> necessary;
+        bool has_model = true;
+        while (!candidates.empty())
+        {
+            const uint32_t dropped = candidates.back();
+            candidates.pop_back();
+            std::vector<uint32_t> allowed(necessary);
+            allowed.insert(allowed.end(), candidates.begin(), candidates.end());
+
+            enumeration.checks++;
+            const cxxsat::Solver::state_t res_drop = check(forbid_others(projection, allowed));
+            has_model = res_drop == cxxsat::Solver::state_t::STATE_SAT;
+            if (has_model) {
+                const model_t model(projection);
+                candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                                [&model](uint32_t idx) { return !model[idx]; }),
+                                 candidates.end());
+                continue;
+            }
+            if (res_drop != cxxsat::Solver::state_t::STATE_UNSAT) enumeration.minimal = false;
+            necessary.push_back(dropped);
+        }
+        std::sort(necessary.begin(), necessary.end());
+
+        // The model of the solver must be a solution of the set
+        if (!has_model) {
+            enumeration.checks++;
+            if (check(forbid_others(projection, necessary)) != cxxsat::Solver::state_t::STATE_SAT)
+                break;
+        }
+
+        enumeration.sets++;
+        if (!report(necessary) || necessary.empty()) break;
+
+        std::vector<var_t> blocking;
+        for (const uint32_t idx : necessary) blocking.push_back(!projection.at(idx));
+        if (blocking.size() <= 7)
+            add_clause_lits(blocking);
+        else
+            cxxsat::solver->add_clause(cxxsat::solver->make_or(blocking));
+    }
+    return enumeration;
+}
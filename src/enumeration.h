@@ -0,0 +1,56 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_ENUMERATION_H
+#define VERIFIER_ENUMERATION_H
+
+#include <functional>
+#include <vector>
+
+#include "Solver.h"
+#include "vars.h"
+
+using var_t = cxxsat::var_t;
+
+// Check of the global solver under the query and extra assumptions
+using enum_check_t = std::function<cxxsat::Solver::state_t(const std::vector<var_t>&)>;
+// Called on each minimal set, the model of the solver being one of its
+// solutions. Returns whether to go on
+using enum_report_t = std::function<bool(const std::vector<uint32_t>&)>;
+
+///////////   Enumeration_t   //////////////////////////////////////////////////
+// Outcome of a projected enumeration
+
+struct enumeration_t
+{
+    uint32_t sets = 0;
+    uint32_t checks = 0;
+    // The query became UNSAT, all minimal sets were enumerated
+    bool complete = false;
+    // A check gave up while shrinking, reported sets may not be minimal
+    bool minimal = true;
+};
+
+/*  Enumerate the models of a query projected on the literals `projection`:
+ *  - each model is shrunk to a minimal set of true projection literals, by
+ *    checking with one more of them forced false until no check is SAT
+ *  - the set is reported, then blocked with its supersets by a clause, so
+ *    that the next model is a new solution of the same incremental solver
+ *  Indices of the sets refer to `projection`
+ */
+enumeration_t enumerate_minimal_sets(const std::vector<var_t>& projection,
+                                     const enum_check_t& check,
+                                     const enum_report_t& report);
+
+#endif // VERIFIER_ENUMERATION_H
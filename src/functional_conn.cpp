@@ -0,0 +1,174 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "bdd.h"
+#include "functional_conn.h"
+#include "Simulator.h"
+
+using bdd_state_t = std::unordered_map<signal_id_t, bdd_t>;
+
+static void init_bdd_constants(bdd_state_t& state)
+{
+    state.emplace(signal_id_t::S_0, bdd_t::ZERO);
+    state.emplace(signal_id_t::S_1, bdd_t::ONE);
+    state.emplace(signal_id_t::S_X, bdd_t::ZERO);
+    state.emplace(signal_id_t::S_Z, bdd_t::ZERO);
+}
+
+/*  Number of BDD variables of the cone: the signals it reads without
+ *  computing them, including the current value of its registers, and the
+ *  faultable gates it computes
+ */
+static uint32_t cone_width(signal_id_t site, const std::vector<const Cell*>& cone,
+                           const std::unordered_set<signal_id_t>& faultable_sigs)
+{
+    std::unordered_set<signal_id_t> computed = {site};
+    std::unordered_set<signal_id_t> boundary;
+    uint32_t flips = 0;
+    for (const Cell* cell : cone)
+    {
+        std::vector<signal_id_t> ins = cell_inputs(cell);
+        if (is_register(cell->type())) ins.push_back(cell->ports().m_dff.m_out_q);
+        for (const signal_id_t in : ins)
+        {
+            if (!is_constant(in) && computed.find(in) == computed.end()) boundary.emplace(in);
+        }
+        if (is_register(cell->type())) continue;
+
+        const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+        computed.emplace(out_y);
+        flips += faultable_sigs.find(out_y) != faultable_sigs.end();
+    }
+    return boundary.size() + flips;
+}
+
+/*  Evaluate the cone with and without the bit-flip of `site`, both copies
+ *  sharing the boundary of the cone and the bit-flips of its faultable gates
+ */
+static std::unordered_set<signal_id_t> flipped_regs(signal_id_t site, const std::vector<const Cell*>& cone,
+                                                    const std::unordered_set<signal_id_t>& faultable_sigs,
+                                                    uint32_t k, bool& overflow)
+{
+    std::array<bdd_state_t, 2> states;
+    std::array<bdd_state_t, 2> next_states;
+    const bdd_t site_var = bdd_t(bdd::manager->new_var());
+    for (uint32_t flip = 0; flip <= 1; flip++)
+    {
+        init_bdd_constants(states.at(flip));
+        states.at(flip).emplace(site, flip ? !site_var : site_var);
+    }
+
+    const bdd_state_t empty;
+    std::vector<bdd::edge_t> flips;
+    std::vector<std::pair<signal_id_t, bdd_t>> diffs;
+    for (const Cell* cell : cone)
+    {
+        std::vector<signal_id_t> ins = cell_inputs(cell);
+        if (is_register(cell->type())) ins.push_back(cell->ports().m_dff.m_out_q);
+        for (const signal_id_t in : ins)
+        {
+            if (states.at(0).find(in) != states.at(0).end()) continue;
+            const bdd_t var = bdd_t(bdd::manager->new_var());
+            for (auto& state : states)
+                state.emplace(in, var);
+        }
+
+        if (is_register(cell->type())) {
+            const signal_id_t out_q = cell->ports().m_dff.m_out_q;
+            for (uint32_t flip = 0; flip <= 1; flip++)
+                cell->eval<bdd_t, bdd_t, bdd_from_bool>(states.at(flip), next_states.at(flip));
+            diffs.emplace_back(out_q, next_states.at(0).at(out_q) ^ next_states.at(1).at(out_q));
+            continue;
+        }
+
+        const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+        for (auto& state : states)
+            cell->eval<bdd_t, bdd_t, bdd_from_bool>(empty, state);
+        if (faultable_sigs.find(out_y) != faultable_sigs.end()) {
+            const bdd_t f = bdd_t(bdd::manager->new_var());
+            for (auto& state : states)
+                state.at(out_y) = state.at(out_y) ^ f;
+            flips.push_back(f.edge);
+        }
+    }
+
+    // Other faults of the cone come on top of the site
+    const bdd_t context = bdd_t(bdd::manager->at_most(flips, k - 1));
+    std::unordered_set<signal_id_t> regs;
+    for (const auto& [reg, diff] : diffs)
+    {
+        if (!((diff & context) == bdd_t::ZERO)) regs.emplace(reg);
+    }
+    overflow = bdd::manager->overflow();
+    return regs;
+}
+
+functional_conn_t compute_functional_conn(const Circuit& circuit,
+                                          const std::unordered_set<signal_id_t>& faultable_sigs,
+                                          uint32_t width, uint32_t k)
+{
+    functional_conn_t functional_conn;
+    const Simulator simulator(circuit);
+
+    // Registers, faultable inputs and gate outputs
+    std::vector<signal_id_t> sites(circuit.regs().begin(), circuit.regs().end());
+    for (signal_id_t sig : faultable_sigs)
+    {
+        if (is_constant(sig)) continue;
+        const Cell* cell = simulator.driver(sig);
+        if (cell == nullptr ? circuit.ins().find(sig) != circuit.ins().end() : !is_register(cell->type()))
+            sites.push_back(sig);
+    }
+    std::sort(sites.begin(), sites.end());
+
+    for (signal_id_t site : sites)
+    {
+        functional_conn.sites++;
+        std::vector<const Cell*> cone;
+        if (!simulator.fanout_cone(site, FCONN_MAX_CONE, cone) ||
+            cone_width(site, cone, faultable_sigs) > width) {
+            functional_conn.wide++;
+            continue;
+        }
+
+        bdd::Manager* const previous_manager = bdd::manager;
+        bdd::manager = new bdd::Manager(FCONN_MAX_NODES);
+        bool overflow;
+        std::unordered_set<signal_id_t> regs = flipped_regs(site, cone, faultable_sigs, k, overflow);
+        delete bdd::manager;
+        bdd::manager = previous_manager;
+
+        if (overflow) {
+            functional_conn.overflows++;
+            continue;
+        }
+        if (regs.size() < circuit.get_conn_regs(site)->size()) functional_conn.reduced++;
+        functional_conn.conn_regs.emplace(site, std::move(regs));
+    }
+    return functional_conn;
+}
+
+std::stringstream functional_conn_info(const functional_conn_t& functional_conn)
+{
+    std::stringstream ss;
+    ss << "******* Functional connections ********" << std::endl;
+    ss << "Fault sites: " << functional_conn.sites << std::endl;
+    ss << "Left to SAT (wide cones): " << functional_conn.wide << std::endl;
+    ss << "Left to SAT (node limit): " << functional_conn.overflows << std::endl;
+    ss << "Fewer registers than connected: " << functional_conn.reduced << std::endl;
+    return ss;
+}
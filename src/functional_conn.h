@@ -0,0 +1,54 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_FUNCTIONAL_CONN_H
+#define VERIFIER_FUNCTIONAL_CONN_H
+
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Circuit.h"
+
+// Fault sites with a larger fanout cone (in cells) are left to SAT
+#define FCONN_MAX_CONE 2000
+// Nodes of the BDD manager of a fault site before it is left to SAT
+#define FCONN_MAX_NODES (1 << 20)
+
+///////////   Functional_conn_t   //////////////////////////////////////////////
+// Registers whose next value a fault site can flip, among those it is
+// structurally connected to. Only sites whose cone fits in the BDD width have
+// an entry, the others keep their structural connections
+
+struct functional_conn_t
+{
+    std::unordered_map<signal_id_t, std::unordered_set<signal_id_t>> conn_regs;
+    uint32_t sites = 0;
+    uint32_t wide = 0;
+    uint32_t overflows = 0;
+    uint32_t reduced = 0;
+};
+
+/*  Compute with BDDs the registers flipped by a bit-flip of each register and
+ *  faultable input or gate, when its fanout cone depends on at most `width`
+ *  boundary signals and bit-flips of the faultable gates of the cone. Along
+ *  with the site, at most `k` - 1 of these gates are flipped
+ */
+functional_conn_t compute_functional_conn(const Circuit& circuit,
+                                          const std::unordered_set<signal_id_t>& faultable_sigs,
+                                          uint32_t width, uint32_t k);
+
+std::stringstream functional_conn_info(const functional_conn_t& functional_conn);
+
+#endif // VERIFIER_FUNCTIONAL_CONN_H
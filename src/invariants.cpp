@@ -0,0 +1,228 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <set>
+
+#include "invariants.h"
+#include "Simulator.h"
+#include "utils.h"
+
+static var_t reg_lit(const std::unordered_map<signal_id_t, var_t>& state, signal_id_t sig, bool pol)
+{
+    return pol ? state.at(sig) : !state.at(sig);
+}
+
+/*  Propose constant registers, equivalent/complementary registers and
+ *  implications between connected registers holding on all simulated values
+ */
+static std::vector<reg_clause_t> propose_candidates(const Circuit& circuit,
+    const std::unordered_map<signal_id_t, std::vector<uint64_t>>& values)
+{
+    std::vector<signal_id_t> regs(circuit.regs().begin(), circuit.regs().end());
+    std::sort(regs.begin(), regs.end());
+
+    std::vector<reg_clause_t> candidates;
+
+    // Signatures are complemented to start with 0, so that complementary
+    // registers fall in the same class
+    std::map<std::vector<uint64_t>, signal_id_t> classes;
+    std::unordered_map<signal_id_t, signal_id_t> repr;
+    for (signal_id_t sig : regs)
+    {
+        const std::vector<uint64_t>& sig_values = values.at(sig);
+        const bool flip = sig_values.front() & 1;
+        std::vector<uint64_t> key(sig_values);
+        if (flip) for (uint64_t& word : key) word = ~word;
+
+        if (std::all_of(key.begin(), key.end(), [](uint64_t word) { return word == 0; })) {
+            candidates.push_back({sig, flip, sig, flip, invariant_kind_t::CONSTANT});
+            continue;
+        }
+
+        const auto& it = classes.emplace(std::move(key), sig).first;
+        const signal_id_t rep = it->second;
+        repr.emplace(sig, rep);
+        if (rep == sig) continue;
+
+        const bool equal = (values.at(rep).front() & 1) == flip;
+        candidates.push_back({sig, true, rep, !equal, invariant_kind_t::EQUIVALENCE});
+        candidates.push_back({sig, false, rep, equal, invariant_kind_t::EQUIVALENCE});
+    }
+
+    // Implications between representatives of registers feeding each other
+    std::set<std::pair<signal_id_t, signal_id_t>> pairs;
+    for (signal_id_t sig : regs)
+    {
+        const auto& f = repr.find(sig);
+        if (f == repr.end() || f->second != sig) continue;
+        for (signal_id_t prev : circuit.get_prev_regs(sig))
+        {
+            const auto& f_prev = repr.find(prev);
+            if (f_prev == repr.end() || f_prev->second == sig) continue;
+            pairs.emplace(std::min(sig, f_prev->second), std::max(sig, f_prev->second));
+        }
+    }
+
+    for (const auto& [a, b] : pairs)
+    {
+        const std::vector<uint64_t>& values_a = values.at(a);
+        const std::vector<uint64_t>& values_b = values.at(b);
+        for (const bool pa : {false, true})
+        {
+            for (const bool pb : {false, true})
+            {
+                if (candidates.size() >= MINING_MAX_CANDIDATES) return candidates;
+                bool holds = true;
+                for (uint32_t pos = 0; holds && pos < values_a.size(); pos++)
+                    holds = ((pa ? values_a.at(pos) : ~values_a.at(pos)) |
+                             (pb ? values_b.at(pos) : ~values_b.at(pos))) == ~0ULL;
+                if (holds) candidates.push_back({a, pa, b, pb, invariant_kind_t::IMPLICATION});
+            }
+        }
+    }
+    return candidates;
+}
+
+// Registers without reset are free on reset, hence a literal must be reset
+static bool holds_on_reset(const Simulator& simulator, const reg_clause_t& clause)
+{
+    bool value;
+    return (simulator.reset_value(clause.a, value) && value == clause.pa) ||
+           (simulator.reset_value(clause.b, value) && value == clause.pb);
+}
+
+/*  Keep the largest subset of candidates that is inductive: assuming all of
+ *  them on a free state, none may fail on the next one. Candidates failing in
+ *  a counterexample are dropped until the solver proves the remaining ones.
+ *  Returns the number of rounds
+ */
+static uint32_t prove_inductive(const Circuit& circuit, std::vector<reg_clause_t>& candidates)
+{
+    cxxsat::Solver* const analysis_solver = cxxsat::solver;
+    cxxsat::solver = new cxxsat::Solver();
+
+    std::unordered_map<signal_id_t, var_t> state;
+    std::unordered_map<signal_id_t, var_t> next_state;
+    init_constants(state);
+    for (signal_id_t sig : circuit.ins()) state.emplace(sig, cxxsat::solver->new_var());
+    for (signal_id_t sig : circuit.regs()) state.emplace(sig, cxxsat::solver->new_var());
+
+    const std::unordered_map<signal_id_t, var_t> empty;
+    for (const Cell* cell : circuit.cells())
+    {
+        if (!is_register(cell->type()))
+            cell->eval<var_t, var_t&, make_const<var_t>>(empty, state);
+    }
+    for (const Cell* cell : circuit.cells())
+    {
+        if (is_register(cell->type()))
+            cell->eval<var_t, var_t&, make_const<var_t>>(state, next_state);
+    }
+
+    // Candidates hold on the first state under their activation literal
+    std::vector<var_t> acts;
+    std::vector<var_t> fails;
+    for (const reg_clause_t& clause : candidates)
+    {
+        const var_t act = cxxsat::solver->new_var();
+        cxxsat::solver->add_clause(!act, reg_lit(state, clause.a, clause.pa),
+                                   reg_lit(state, clause.b, clause.pb));
+        acts.push_back(act);
+        fails.push_back(!(reg_lit(next_state, clause.a, clause.pa) |
+                          reg_lit(next_state, clause.b, clause.pb)));
+    }
+
+    std::vector<bool> alive(candidates.size(), true);
+    uint32_t rounds = 0;
+    while (true)
+    {
+        std::vector<var_t> alive_fails;
+        for (uint32_t idx = 0; idx < candidates.size(); idx++)
+        {
+            if (!alive.at(idx)) continue;
+            cxxsat::solver->assume(acts.at(idx));
+            alive_fails.push_back(fails.at(idx));
+        }
+        if (alive_fails.empty()) break;
+
+        rounds++;
+        cxxsat::solver->assume(cxxsat::solver->make_or(alive_fails));
+        if (cxxsat::solver->check() == cxxsat::Solver::state_t::STATE_UNSAT) break;
+
+        const model_t model(fails);
+        for (uint32_t idx = 0; idx < candidates.size(); idx++)
+        {
+            if (alive.at(idx) && model[idx]) alive.at(idx) = false;
+        }
+    }
+
+    delete cxxsat::solver;
+    cxxsat::solver = analysis_solver;
+
+    std::vector<reg_clause_t> proven;
+    for (uint32_t idx = 0; idx < candidates.size(); idx++)
+    {
+        if (alive.at(idx)) proven.push_back(candidates.at(idx));
+    }
+    candidates = std::move(proven);
+    return rounds;
+}
+
+mined_invariants_t mine_invariants(const Circuit& circuit, uint32_t cycles)
+{
+    mined_invariants_t invariants;
+    const Simulator simulator(circuit);
+    const auto values = simulator.simulate_from_reset(cycles, 42);
+
+    std::vector<reg_clause_t> candidates = propose_candidates(circuit, values);
+    invariants.candidates = candidates.size();
+
+    for (const reg_clause_t& clause : candidates)
+    {
+        if (holds_on_reset(simulator, clause))
+            invariants.clauses.push_back(clause);
+        else
+            invariants.not_initial++;
+    }
+
+    invariants.rounds = prove_inductive(circuit, invariants.clauses);
+    return invariants;
+}
+
+std::stringstream mined_invariants_info(const mined_invariants_t& invariants)
+{
+    std::stringstream ss;
+    std::array<uint32_t, 3> by_kind = {0};
+    for (const reg_clause_t& clause : invariants.clauses)
+        by_kind.at(static_cast<uint32_t>(clause.kind))++;
+
+    ss << "******* Mined invariants ********" << std::endl;
+    ss << "Candidates: " << invariants.candidates;
+    ss << " (" << invariants.not_initial << " not holding on reset)" << std::endl;
+    ss << "Proven clauses: " << invariants.clauses.size() << " in " << invariants.rounds << " rounds";
+    ss << " (constants " << by_kind.at(0) << ", equivalences " << by_kind.at(1);
+    ss << ", implications " << by_kind.at(2) << ")" << std::endl;
+    return ss;
+}
+
+void assert_mined_invariants(const mined_invariants_t& invariants,
+                             const std::unordered_map<signal_id_t, var_t>& state)
+{
+    for (const reg_clause_t& clause : invariants.clauses)
+        cxxsat::solver->add_clause(reg_lit(state, clause.a, clause.pa),
+                                   reg_lit(state, clause.b, clause.pb));
+}
@@ -0,0 +1,68 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_INVARIANTS_H
+#define VERIFIER_INVARIANTS_H
+
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "Circuit.h"
+#include "vars.h"
+#include "Solver.h"
+
+using var_t = cxxsat::var_t;
+
+// Maximal number of candidate invariants submitted to the inductive proof
+#define MINING_MAX_CANDIDATES 50000
+
+///////////   Reg_clause_t   ///////////////////////////////////////////////////
+// A clause `a == pa || b == pb` over the registers of a circuit state, with
+// `b == a` for unit clauses. Equivalences are split in two clauses
+
+enum class invariant_kind_t : uint32_t { CONSTANT, EQUIVALENCE, IMPLICATION };
+
+struct reg_clause_t
+{
+    signal_id_t a;
+    bool pa;
+    signal_id_t b;
+    bool pb;
+    invariant_kind_t kind;
+};
+
+struct mined_invariants_t
+{
+    std::vector<reg_clause_t> clauses;
+    uint32_t candidates = 0;
+    uint32_t not_initial = 0;
+    uint32_t rounds = 0;
+};
+
+/*  Mine invariants of the states reachable from reset:
+ *  - candidates hold during `cycles` clock cycles of random simulation
+ *  - the proven ones hold on reset (registers with a reset take their reset
+ *    value, the others are free) and are inductive together
+ *  The circuit is assumed to start from a reset of all its registers
+ */
+mined_invariants_t mine_invariants(const Circuit& circuit, uint32_t cycles);
+
+std::stringstream mined_invariants_info(const mined_invariants_t& invariants);
+
+// Assert the mined invariants on the registers of `state`
+void assert_mined_invariants(const mined_invariants_t& invariants,
+                             const std::unordered_map<signal_id_t, var_t>& state);
+
+#endif // VERIFIER_INVARIANTS_H
@@ -13,10 +13,19 @@
  */
 
 #include <chrono>
+#include <csignal>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <random>
 #include <set>
 #include <sstream>
+#include <thread>
+
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "Cell.h"
 #include "Circuit.h"
@@ -24,27 +33,139 @@
 #include "utils.h"
 #include "config.h"
 #include "vars.h"
+#include "xor_chains.h"
+#include "cut_cover.h"
+#include "cnf.h"
+#include "backend.h"
+#include "invariants.h"
+#include "odc.h"
+#include "cegar.h"
+#include "functional_conn.h"
+#include "parallel.h"
+#include "enumeration.h"
+#include "workqueue.h"
+#include "batch.h"
+#include "result_cache.h"
+#include "daemon.h"
 #include "json.hpp"
 
 #define MAX_ITER 2000
-#define SAT_TIMEOUT 30
 
 using var_t = cxxsat::var_t;
 
+// Alerts and invariants constraining the unrolling, in a fixed order
+static void constraints_key(const config_t& CONF, std::stringstream& key)
+{
+    const std::map<std::string, std::vector<bool>> alerts(CONF.alert_list.begin(), CONF.alert_list.end());
+    const std::map<std::string, std::vector<bool>> invariants(CONF.invariant_list.begin(),
+                                                              CONF.invariant_list.end());
+    for (const auto& it : alerts) {
+        key << " alert " << it.first << "=";
+        for (bool b : it.second) key << b;
+    }
+    for (const auto& it : invariants) {
+        key << " invariant " << it.first << "=";
+        for (bool b : it.second) key << b;
+    }
+}
+
+/*  Key of the unrolling of `depth` + 1 clock cycles in the CNF cache. It holds
+ *  everything the base CNF depends on: netlist, fault scope, alerts,
+ *  invariants and encodings
+ */
+static std::string cnf_cache_key(const config_t& CONF, const Circuit& circuit,
+                                 const std::unordered_set<signal_id_t>& faultable_sigs,
+                                 uint32_t depth)
+{
+    std::stringstream key;
+    key << std::hex << "circuit " << circuit_hash(circuit) << " faults " << signals_hash(faultable_sigs);
+    key << std::dec << " depth " << depth << " xor " << CONF.optim_xor << " cut " << CONF.cut_size;
+    key << " sweep " << CONF.optim_sweep << " delta " << CONF.optim_delta;
+    constraints_key(CONF, key);
+    return key.str();
+}
+
+/*  Key of a query in the result cache, from the meaning of the unrolling of
+ *  `depth` + 1 clock cycles and of the `partitions`, leaving out the
+ *  encodings. The procedures append their fault budget
+ */
+static std::string result_cache_key(const config_t& CONF, const Circuit& circuit,
+                                    const std::unordered_set<signal_id_t>& faultable_sigs,
+                                    const std::vector<std::unordered_set<signal_id_t>>& partitions,
+                                    uint32_t depth)
+{
+    std::stringstream key;
+    key << std::hex << "circuit " << circuit_hash(circuit) << " faults " << signals_hash(faultable_sigs);
+    key << " partitions " << partitions_hash(partitions);
+    key << std::dec << " depth " << depth << " mined " << CONF.mine_invariants;
+    constraints_key(CONF, key);
+    return key.str();
+}
+
+/*  Unroll the first `depth` + 1 clock cycles, through the CNF cache if enabled.
+ *  The CNF of the unrolling is kept in `kept` when given
+ */
+static void unroll_base(const config_t& CONF, const Circuit& circuit,
+                        std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+                        std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                        const std::unordered_set<signal_id_t>& faultable_sigs,
+                        std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& comb_faults,
+                        const std::unordered_set<signal_id_t>& alert_signals,
+                        const encoding_t& encoding, uint32_t depth, std::ostream& out,
+                        cnf_unrolling_t* kept = nullptr)
+{
+    if (CONF.cnf_cache_path.empty() && kept == nullptr) {
+        for (uint32_t cycle = 0; cycle <= depth; cycle++)
+            unroll_cycle(circuit, golden_trace, faulty_trace, faultable_sigs, comb_faults,
+                         alert_signals, CONF.invariant_list, CONF.alert_list, encoding);
+        return;
+    }
+    if (CONF.cnf_cache_path.empty()) {
+        unroll_with_cnf_cache(circuit, golden_trace, faulty_trace, faultable_sigs, comb_faults,
+                              alert_signals, CONF.invariant_list, CONF.alert_list, encoding,
+                              depth, "", "", kept);
+        return;
+    }
+
+    const std::string key = cnf_cache_key(CONF, circuit, faultable_sigs, depth);
+    std::stringstream file_name;
+    file_name << CONF.cnf_cache_path << "/" << std::hex << fnv1a(key) << ".cnf";
+    std::filesystem::create_directories(CONF.cnf_cache_path);
+
+    const bool cached = unroll_with_cnf_cache(circuit, golden_trace, faulty_trace, faultable_sigs,
+                                              comb_faults, alert_signals, CONF.invariant_list,
+                                              CONF.alert_list, encoding, depth, file_name.str(), key, kept);
+    out << (cached ? "Loaded" : "Saved") << " CNF of " << depth + 1 << " clock cycles ";
+    out << (cached ? "from" : "in") << " `" << file_name.str() << "`" << std::endl;
+}
 
-void check_k_fault_resistant_partitioning(std::string config_name)
+
+void check_k_fault_resistant_partitioning(std::string config_name, bool worker,
+                                          Circuit* design = nullptr,
+                                          const nlohmann::json& overrides = nlohmann::json::object())
 {
     // Import configuration from file
-    config_t CONF("config/config_file.json", config_name);
-    std::ofstream out(CONF.dump_path + "/log");
+    config_t CONF("config/config_file.json", config_name, !worker, overrides);
+
+    // A worker only checks the splits of Procedure 2 posted by its coordinator
+    WorkQueue queue(CONF.work_queue);
+    if (worker) {
+        if (CONF.work_queue.empty())
+            throw std::logic_error(ILLEGAL_WORKER_QUEUE);
+        CONF.procedure = PROC_2;
+        std::filesystem::create_directories(CONF.work_queue);
+    }
+    std::ofstream out(worker ? CONF.work_queue + "/worker-" + std::to_string(getpid()) + ".log"
+                             : CONF.dump_path + "/log");
 
-    Circuit* circuit = new Circuit(CONF.design_path, CONF.design_name);
+    // A design parsed by the batch runner belongs to it
+    Circuit* circuit = design ? design : new Circuit(CONF.design_path, CONF.design_name);
 
     // Extract subcircuit if needed.
     if (CONF.subcircuit) {
         Circuit* subcircuit = new Circuit(*circuit,
             CONF.subcircuit_interface_path, CONF.subcircuit_interface_name);
-        delete circuit;
+        if (circuit != design) delete circuit;
         circuit = subcircuit;
     }
 
@@ -74,9 +195,67 @@ void check_k_fault_resistant_partitioning(std::string config_name)
         *circuit, CONF.f_included_prefix, CONF.f_excluded_prefix,
         CONF.f_excluded_signals, CONF.exclude_inputs);
 
+    // Signals observed by the analysis are materialized by every encoding
+    std::unordered_set<signal_id_t> kept_sigs(alert_signals);
+    kept_sigs.insert(circuit->outs().begin(), circuit->outs().end());
+    for (const auto& inv : CONF.invariant_list)
+    {
+        const std::vector<signal_id_t>& sigs = (*circuit)[inv.first];
+        kept_sigs.insert(sigs.begin(), sigs.end());
+    }
+
+    // Prune fault sites masked in every state
+    if (CONF.optim_odc) {
+        const odc_pruning_t odc_pruning = compute_odc_pruning(*circuit, faultable_sigs, kept_sigs);
+        out << odc_pruning_info(odc_pruning).str();
+        for (const signal_id_t& sig : odc_pruning.pruned) faultable_sigs.erase(sig);
+    }
+
+    // Merge equivalent golden signals before encoding faults
+    sweeping_t sweeping;
+    if (CONF.optim_sweep) {
+        sweeping = compute_sweeping(*circuit, CONF.sat_backend);
+        out << sweeping_info(sweeping).str();
+    }
+
+    // Collapse XOR trees into parity constraints
+    encoding_t encoding;
+    if (CONF.optim_sweep) encoding.sweeping = &sweeping;
+    encoding.delta = CONF.optim_delta;
+    xor_chains_t xor_chains;
+    if (CONF.optim_xor) {
+        xor_chains = extract_xor_chains(*circuit, kept_sigs);
+        out << xor_chains_info(xor_chains).str();
+        encoding.xor_chains = &xor_chains;
+    }
+
+    // Cover non-faultable logic with LUTs, leaving XOR trees to their chains
+    cut_cover_t cut_cover;
+    if (CONF.cut_size > 0) {
+        std::unordered_set<signal_id_t> lut_kept_sigs(kept_sigs);
+        lut_kept_sigs.insert(faultable_sigs.begin(), faultable_sigs.end());
+        std::unordered_set<signal_id_t> excluded_sigs(xor_chains.inner);
+        for (const auto& it : xor_chains.roots) excluded_sigs.emplace(it.first);
+        cut_cover = compute_cut_cover(*circuit, CONF.cut_size, lut_kept_sigs, excluded_sigs);
+        out << cut_cover_info(cut_cover).str();
+        encoding.cut_cover = &cut_cover;
+    }
+
+    // Invariants of the states reachable from reset, asserted on the initial state
+    mined_invariants_t mined_invariants;
+    if (CONF.mine_invariants > 0) {
+        mined_invariants = mine_invariants(*circuit, CONF.mine_invariants);
+        out << mined_invariants_info(mined_invariants).str();
+    }
+
+    // Registers each fault site can flip, refining the connections of `optim_atleast2`
+    functional_conn_t functional_conn;
+    if (CONF.bdd_width > 0 && CONF.optim_atleast2 && CONF.procedure != PROC_2) {
+        functional_conn = compute_functional_conn(*circuit, faultable_sigs, CONF.bdd_width, CONF.k);
+        out << functional_conn_info(functional_conn).str();
+    }
 
     // Set time format for dumped files
-    srand(42);
     std::chrono::time_point start_time = std::chrono::system_clock::now();
     std::time_t st = std::chrono::system_clock::to_time_t(start_time);
     char time_str[100];
@@ -93,6 +272,18 @@ void check_k_fault_resistant_partitioning(std::string config_name)
     // k_f_comb_next  :   number of combinational faults at the next clock cycles
 
     uint32_t solver_iter = 0;
+
+    // Answers of the queries decided by earlier runs
+    ResultCache result_cache(CONF.result_cache_path);
+
+    // Procedure 2 of each fault order but the last runs in a forked process as
+    // soon as Procedure 1 is done with it, on the partitions reached then:
+    // - `pipelined_k` is the order checked by such a process, 0 in the parent
+    // - `pipelined` holds the process and the partitions of each order
+    const bool pipelining = CONF.pipeline_proc2 && CONF.procedure == BOTH && CONF.increasing_k &&
+                            CONF.work_queue.empty() && !worker;
+    uint32_t pipelined_k = 0;
+    std::map<uint32_t, std::pair<pid_t, uint64_t>> pipelined;
     
     if (CONF.procedure != PROC_2) {
 
@@ -110,30 +301,31 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
         cxxsat::solver = new cxxsat::Solver();
 
-        for (uint32_t cycle = 0; cycle <= std::max(uint32_t(1), CONF.delay); cycle++)
-        {
-            if (cycle == 0)
-            {
-                unroll_init_with_faults(*circuit, golden_trace, faulty_trace,
-                                        faultable_sigs, comb_faults);
-                // Assume invariant on golden trace
-                assert_invariants_at_step(*circuit, golden_trace, CONF.invariant_list, 0);               
-            } else {
-                unroll_with_faults(*circuit, golden_trace, faulty_trace,
-                                faultable_sigs, comb_faults, alert_signals);
-            }
-
-            // Assume no alert at each step 
-            assert_no_alert_at_step(*circuit, golden_trace, faulty_trace, CONF.alert_list, cycle);
+        // The abstraction encodes gates on demand, without the optional encodings
+        std::unique_ptr<AbstractUnrolling> abstraction;
+        if (CONF.cegar) {
+            abstraction = std::make_unique<AbstractUnrolling>(*circuit, golden_trace, faulty_trace,
+                faultable_sigs, comb_faults, alert_signals, CONF.invariant_list, CONF.alert_list,
+                std::max(uint32_t(1), CONF.delay));
+        } else {
+            unroll_base(CONF, *circuit, golden_trace, faulty_trace, faultable_sigs, comb_faults,
+                        alert_signals, encoding, std::max(uint32_t(1), CONF.delay), out);
         }
+        assert_mined_invariants(mined_invariants, golden_trace.at(0));
 
         assert(comb_faults.size() == 1 + std::max(uint32_t(1), CONF.delay));
 
         ////////////////////////////////////////////////////////////////////////////
         //      Build vectors of partition differences at cycle 0 and 1
         ////////////////////////////////////////////////////////////////////////////
+        // The differences of a partition are only defined under its activation
+        // literal, which is retired when the partition is merged
         std::array<std::unordered_map<signal_id_t, var_t>, 2> seq_faults;
         std::array<std::vector<var_t>, 2> partitions_diff;
+        std::vector<var_t> partitions_act;
+        for (uint32_t part_idx = 0; part_idx < partitions.size(); part_idx++)
+            partitions_act.push_back(cxxsat::solver->new_var());
+
         for (uint32_t cycle = 0; cycle <= 1; cycle++)
         {
             const auto& golden_state = golden_trace.at(cycle);
@@ -141,8 +333,9 @@ void check_k_fault_resistant_partitioning(std::string config_name)
             auto& curr_diff = partitions_diff.at(cycle);
             auto& curr_fault = seq_faults.at(cycle);
 
-            for (const auto& partition : partitions)
+            for (uint32_t part_idx = 0; part_idx < partitions.size(); part_idx++)
             {
+                const auto& partition = partitions.at(part_idx);
                 std::vector<var_t> current_partition_diff;
                 for (const auto& sig : partition)
                 {
@@ -154,24 +347,42 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                     current_partition_diff.push_back(var);
                     curr_fault.emplace(sig, var);
                 }
-                curr_diff.push_back(cxxsat::solver->make_or(current_partition_diff));
+                curr_diff.push_back(make_guarded_or(current_partition_diff, partitions_act.at(part_idx)));
             }
         }
 
         ////////////////////////////////////////////////////////////////////////////
         //      Build vectors of combinational faults at cycle 0 and 1:d
         ////////////////////////////////////////////////////////////////////////////
+        // They grow with the abstraction when it is refined
         std::array<std::vector<var_t>, 2> comb_fault_vars;
-        for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
+        auto collect_comb_fault_vars = [&]()
         {
-            for (const auto& m_sig_fault : comb_faults.at(cycle))
-                comb_fault_vars.at(cycle ? 1 : 0).push_back(m_sig_fault.second.is_faulted());
-        }
+            comb_fault_vars.at(0).clear();
+            comb_fault_vars.at(1).clear();
+            for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
+            {
+                for (const auto& m_sig_fault : comb_faults.at(cycle))
+                    comb_fault_vars.at(cycle ? 1 : 0).push_back(m_sig_fault.second.is_faulted());
+            }
+        };
+        collect_comb_fault_vars();
 
         const auto start_proc1{std::chrono::steady_clock::now()};
 
         std::unordered_set<signal_id_t> enumerate_comb_faults;
 
+        // Execution of the last counterexample, first tried by the next query
+        std::vector<var_t> warm_state;
+        uint32_t warm_tries = 0;
+        uint32_t warm_hits = 0;
+
+        // Choice of the partitions merged together, reproducible across runs
+        std::mt19937 merge_rng(42);
+
+        // Speculative workers need a concrete model and merge their findings
+        const bool speculating = CONF.speculative > 1 && !abstraction && !CONF.enumerate_exploitable;
+
         // Print banner
         out << std::endl << std::string(80, '*') << std::endl;
         out << std::string(20, ' ') << "Procedure 1 -- Build partitions";
@@ -200,34 +411,79 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
                     // Reset solver state to SAT
                     cxxsat::Solver::state_t res = cxxsat::Solver::state_t::STATE_SAT;
+                    warm_state.clear();
 
-
-                    // Iterate until a fixed point for the current partitioning analysis
-                    for (solver_iter++;solver_iter<MAX_ITER;solver_iter++)
+                    auto partitioning_assumptions = [&](bool seq_counter)
                     {
-                        /////////////    OPTIM (at least 2 conn parts)     /////////
-                        if (CONF.optim_atleast2) {
-                            out << optim_at_least_2_conn_parts(*circuit, partitions,
-                                                comb_faults.at(0), partitions_diff.at(0)).str();
-                        }
+                        auto at_most = [seq_counter](const std::vector<var_t>& ops, uint32_t k)
+                        {
+                            if (seq_counter) return make_seq_at_most(ops, k);
+                            return cxxsat::solver->make_at_most(ops, k);
+                        };
 
-                        ///////////////////     ASSUMPTIONS     ///////////////////////
+                        // Differences of the current partitions are defined
+                        std::vector<var_t> assumptions(partitions_act);
 
                         // Initially, at most `k_f_comb_init` comb faults
-                        cxxsat::solver->assume(
-                            cxxsat::solver->make_at_most(comb_fault_vars.at(0), k_f_comb_init));
+                        assumptions.push_back(at_most(comb_fault_vars.at(0), k_f_comb_init));
 
                         // Next states, at most `k_f_comb_next` comb faults on alert signals
-                        cxxsat::solver->assume(
-                            cxxsat::solver->make_at_most(comb_fault_vars.at(1), k_f_comb_next));
+                        assumptions.push_back(at_most(comb_fault_vars.at(1), k_f_comb_next));
 
                         // Initially, at most `k_f_part` partitions faulted
-                        cxxsat::solver->assume(
-                            cxxsat::solver->make_at_most(partitions_diff.at(0), k_f_part));
+                        assumptions.push_back(at_most(partitions_diff.at(0), k_f_part));
 
                         // Next state, at least `k_f_part + k_f_comb_init` partitions faulted
-                        cxxsat::solver->assume(
+                        assumptions.push_back(
                             cxxsat::solver->make_at_least(partitions_diff.at(1), k_faults + 1));
+                        return assumptions;
+                    };
+
+                    // Forked checks replay the model of their winner on the free variables
+                    auto model_vars = [&]()
+                    {
+                        if (CONF.portfolio <= 1 && CONF.query_timeout == 0 && CONF.cube_after == 0 && !speculating)
+                            return std::vector<var_t>();
+                        return unrolling_free_vars(*circuit, golden_trace, faulty_trace, comb_faults);
+                    };
+
+                    auto check_partitioning = [&](const std::vector<var_t>& assumptions)
+                    {
+                        // Queries still running after `cube_after` are split into
+                        // cubes over the faults allowed at the initial state
+                        if (CONF.cube_after)
+                        {
+                            const std::vector<var_t> vars = model_vars();
+                            cxxsat::Solver::state_t res_whole =
+                                check_portfolio(CONF.portfolio, assumptions, vars, CONF.cube_after * 1000);
+                            if (res_whole != cxxsat::Solver::state_t::STATE_INPUT) return res_whole;
+
+                            const std::vector<var_t>& split_lits =
+                                k_f_part ? partitions_diff.at(0) : comb_fault_vars.at(k_f_comb_init ? 0 : 1);
+                            out << "split into cubes, " << std::flush;
+                            return check_cubes(make_region_cubes(split_lits, CONF.cube_regions),
+                                               assumptions, vars, CONF.query_timeout * 1000, out);
+                        }
+                        return check_escalating(CONF.portfolio, CONF.query_timeout * 1000,
+                            [&](bool seq_counter)
+                            {
+                                return seq_counter ? partitioning_assumptions(true) : assumptions;
+                            }, model_vars(), out);
+                    };
+
+                    // Iterate until a fixed point for the current partitioning analysis
+                    for (solver_iter++;solver_iter<MAX_ITER;solver_iter++)
+                    {
+                        /////////////    OPTIM (at least 2 conn parts)     /////////
+                        if (CONF.optim_atleast2) {
+                            out << optim_at_least_2_conn_parts(*circuit, partitions,
+                                                comb_faults.at(0), seq_faults.at(0),
+                                                &functional_conn.conn_regs).str();
+                        }
+
+                        ///////////////////     ASSUMPTIONS     ///////////////////////
+
+                        std::vector<var_t> assumptions = partitioning_assumptions(false);
 
                         // Assume no comb faults that we already enumerated
                         if (CONF.enumerate_exploitable) {
@@ -245,13 +501,93 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                         out << std::endl << "  Running solver " << solver_iter << ": " << std::flush;
 
                         const auto start_check{std::chrono::steady_clock::now()};
-                        res = cxxsat::solver->check();
+
+                        // A query decided by an earlier run is only replayed. The
+                        // abstraction leaves the unrolling incomplete
+                        const bool caching = result_cache.enabled() && !abstraction;
+                        std::string query_key;
+                        std::vector<var_t> cache_vars;
+                        bool cached = false;
+                        if (caching) {
+                            std::stringstream key;
+                            key << result_cache_key(CONF, *circuit, faultable_sigs, partitions,
+                                                    std::max(uint32_t(1), CONF.delay));
+                            key << " proc1 k " << k_faults << " part " << k_f_part;
+                            key << " init " << k_f_comb_init << " next " << k_f_comb_next;
+                            key << " atleast2 " << CONF.optim_atleast2 << " bdd " << CONF.bdd_width;
+                            if (CONF.enumerate_exploitable)
+                                key << std::hex << " blocked " << signals_hash(enumerate_comb_faults);
+                            query_key = key.str();
+                            cache_vars = unrolling_free_vars(*circuit, golden_trace, faulty_trace, comb_faults);
+                            cached = result_cache.lookup(query_key, assumptions, cache_vars, res);
+                        }
+
+                        // Once merged, the partitions are often still broken from the
+                        // execution of the last counterexample, leaving only the
+                        // faults to the solver
+                        bool warm_hit = false;
+                        if (!cached && !warm_state.empty())
+                        {
+                            std::vector<var_t> warm_assumptions(assumptions);
+                            warm_assumptions.insert(warm_assumptions.end(), warm_state.begin(), warm_state.end());
+                            warm_hit = check_portfolio(CONF.portfolio, warm_assumptions, model_vars(),
+                                                       CONF.query_timeout * 1000) == cxxsat::Solver::state_t::STATE_SAT;
+                            warm_tries++;
+                            warm_hits += warm_hit;
+                        }
+                        // Speculative workers propose counterexamples of the same
+                        // partitions, the first one being replayed here
+                        std::vector<std::vector<uint32_t>> proposals;
+                        if (warm_hit) {
+                            res = cxxsat::Solver::state_t::STATE_SAT;
+                        } else if (cached) {
+                            // Answered by the cache
+                        } else if (speculating) {
+                            speculation_t speculation = speculate(CONF.speculative, assumptions, model_vars(),
+                                                                  partitions_diff.at(1), CONF.query_timeout * 1000);
+                            res = speculation.state;
+                            proposals = std::move(speculation.proposals);
+                            if (res == cxxsat::Solver::state_t::STATE_INPUT) {
+                                out << "timeout, retry alone: " << std::flush;
+                                res = check_partitioning(assumptions);
+                            }
+                        } else {
+                            res = check_partitioning(assumptions);
+                        }
+
+                        // Refine the abstraction until the counterexample is concrete
+                        uint32_t refinements = 0;
+                        while (abstraction && res == cxxsat::Solver::state_t::STATE_SAT)
+                        {
+                            if (abstraction->refine() == 0) break;
+                            refinements++;
+                            collect_comb_fault_vars();
+                            if (CONF.optim_atleast2)
+                                optim_at_least_2_conn_parts(*circuit, partitions,
+                                                            comb_faults.at(0), seq_faults.at(0),
+                                                            &functional_conn.conn_regs);
+                            res = check_partitioning(partitioning_assumptions(false));
+                        }
+                        if (caching && !cached) result_cache.store(query_key, res, cache_vars);
                         const auto end_check{std::chrono::steady_clock::now()};
 
                         const auto check_time = end_check - start_check;
                         uint32_t check_time_ms =
                             std::chrono::duration_cast<std::chrono::milliseconds>(check_time).count();
                         out << check_time_ms / 1000 << "." << (check_time_ms % 1000) << " s -> ";
+                        if (abstraction) {
+                            out << "(" << refinements << " refinements, ";
+                            out << abstraction->num_refined() << " cones) ";
+                        }
+                        if (warm_hit) out << "(warm start) ";
+                        if (cached) out << "(cached) ";
+
+                        // Every escalation timed out, the fixed point stays unknown
+                        if (res == cxxsat::Solver::state_t::STATE_INPUT)
+                        {
+                            out << " UNKNOWN" << std::endl;
+                            break;
+                        }
 
                         // We reach a fixed point and cannot merge more partitions
                         if (res != cxxsat::Solver::state_t::STATE_SAT)
@@ -262,6 +598,45 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
                         out << " SAT " << std::endl;
 
+                        // Record the inputs and initial registers of the counterexample
+                        if (CONF.warm_start)
+                        {
+                            warm_state.clear();
+                            for (uint32_t cycle = 0; cycle < golden_trace.size(); cycle++)
+                            {
+                                for (const auto* sigs : {&circuit->ins(), &circuit->regs()})
+                                {
+                                    if (cycle > 0 && sigs == &circuit->regs()) continue;
+                                    for (const signal_id_t sig : *sigs)
+                                    {
+                                        for (const auto* trace : {&golden_trace, &faulty_trace})
+                                        {
+                                            const auto& it = trace->at(cycle).find(sig);
+                                            if (it != trace->at(cycle).end()) warm_state.push_back(it->second);
+                                        }
+                                    }
+                                }
+                            }
+                            const model_t warm_model(warm_state);
+                            for (size_t idx = 0; idx < warm_state.size(); idx++)
+                            {
+                                if (!warm_model[idx]) warm_state[idx] = !warm_state[idx];
+                            }
+                        }
+
+                        // Read the faults of the counterexample at once
+                        std::vector<var_t> readout;
+                        for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
+                        {
+                            for (const auto& fault : comb_faults.at(cycle))
+                                readout.push_back(fault.second.f0);
+                        }
+                        const size_t diff0_beg = readout.size();
+                        readout.insert(readout.end(), partitions_diff.at(0).begin(), partitions_diff.at(0).end());
+                        const size_t diff1_beg = readout.size();
+                        readout.insert(readout.end(), partitions_diff.at(1).begin(), partitions_diff.at(1).end());
+                        const model_t model(readout);
+
                         // Look for faulty partitions to be merged
                         std::vector<std::vector<uint32_t>> to_be_merged;
 
@@ -270,12 +645,13 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
                         // Show comb gates initially faulty
                         {
+                            size_t fault_pos = 0;
                             for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
                             {
                                 std::vector<signal_id_t> faulty_sig_comb;
                                 for (const auto& fault : comb_faults.at(cycle))
                                 {
-                                    if (cxxsat::solver->value(fault.second.f0))
+                                    if (model[fault_pos++])
                                     {
                                         faulty_sig_comb.push_back(fault.first);
                                     }
@@ -298,17 +674,8 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                         }
 
                         // Show partitions initially faulted
-                        std::vector<uint32_t> faulty_indexes_initial;
+                        std::vector<uint32_t> faulty_indexes_initial = model.true_indexes(diff0_beg, diff1_beg);
                         {
-                            for (uint32_t part_idx = 0; part_idx < partitions_diff.at(0).size();
-                                part_idx++)
-                            {
-                                const var_t& s = partitions_diff.at(0).at(part_idx);
-                                if (cxxsat::solver->value(s))
-                                {
-                                    faulty_indexes_initial.push_back(part_idx);
-                                }
-                            }
                             assert(faulty_indexes_initial.size() <= k_f_part);
                             out << "  - Faulty partitions (initial): ";
                             for (uint32_t idx : faulty_indexes_initial)
@@ -325,12 +692,7 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
                         // Find all violating partitions in next state
                         {
-                            for (uint32_t part_idx = 0; part_idx < partitions_diff.at(1).size();
-                                part_idx++)
-                            {
-                                const var_t& s = partitions_diff.at(1).at(part_idx);
-                                if (cxxsat::solver->value(s)) { faulty_indexes_next.push_back(part_idx); }
-                            }
+                            faulty_indexes_next = model.true_indexes(diff1_beg, model.size());
 
                             out << "  - Faulty partitions (next): ";
                             for (uint32_t idx : faulty_indexes_next)
@@ -357,6 +719,14 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                         }
 
 
+                        // Other proposals are merged after the counterexample shown
+                        // above, unless they overlap with earlier ones
+                        if (proposals.size() > 1) {
+                            assert(proposals.front() == to_be_merged.back());
+                            out << "  - Speculative proposals: " << proposals.size() << std::endl;
+                            to_be_merged.insert(to_be_merged.begin(), proposals.rbegin(), proposals.rend() - 1);
+                        }
+
                         ///////////////////     Merge strategy     /////////////////
                         // try to merge from best found to worst, while ignoring
                         // everything that is made impossible
@@ -394,7 +764,7 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                                         next_bucket += merged_size;
                                         assert(merged_indexes.size() <= k_faults);
                                     }
-                                    uint32_t chosen_idx_idx = (uint64_t)rand() % index_copies.size();
+                                    uint32_t chosen_idx_idx = merge_rng() % index_copies.size();
                                     merged_indexes.back().push_back(index_copies.at(chosen_idx_idx));
                                     index_copies.erase(index_copies.begin() + chosen_idx_idx);
                                 }
@@ -412,24 +782,35 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                                         out << fi << " ";
                                         merged.insert(partitions.at(fi).begin(), 
                                                     partitions.at(fi).end());
-                                        diffs0.push_back(partitions_diff.at(0).at(fi));
-                                        diffs1.push_back(partitions_diff.at(1).at(fi));
                                     }
                                     out << std::endl;
 
+                                    // Define the merged differences from the registers,
+                                    // so that the merged partitions can be retired
+                                    for (const signal_id_t& sig : merged)
+                                    {
+                                        diffs0.push_back(seq_faults.at(0).at(sig));
+                                        diffs1.push_back(seq_faults.at(1).at(sig));
+                                    }
+                                    var_t act = cxxsat::solver->new_var();
+
                                     partitions.push_back(merged);
-                                    partitions_diff.at(0).push_back(cxxsat::solver->make_or(diffs0));
-                                    partitions_diff.at(1).push_back(cxxsat::solver->make_or(diffs1));
+                                    partitions_act.push_back(act);
+                                    partitions_diff.at(0).push_back(make_guarded_or(diffs0, act));
+                                    partitions_diff.at(1).push_back(make_guarded_or(diffs1, act));
                                 }
                             }
 
                             // remove all the partitions that have now been merged
-                            // this works because the removed_next are sorted upwards
+                            // this works because the removed_next are sorted upwards.
+                            // Their retired definitions become satisfied clauses
                             uint32_t num_removed = 0;
                             uint32_t last_idx = -1U;
                             for (uint32_t fi : removed_next)
                             {
                                 assert((last_idx == -1U) || (fi > last_idx));
+                                cxxsat::solver->add_clause(!partitions_act.at(fi - num_removed));
+                                partitions_act.erase(partitions_act.begin() + fi - num_removed);
                                 partitions.erase(partitions.begin() + fi - num_removed);
                                 partitions_diff.at(0).erase(partitions_diff.at(0).begin() + fi - num_removed);
                                 partitions_diff.at(1).erase(partitions_diff.at(1).begin() + fi - num_removed);
@@ -444,9 +825,12 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                         out << partition_info(*circuit, partitions, CONF.interesting_names).str();
                     }
 
-                    // solver has returned UNSAT
-                    out << "  Partitioning finished with " << partitions.size()
-                        << " partitions." << std::endl;
+                    // solver has returned UNSAT, or gave up
+                    if (res == cxxsat::Solver::state_t::STATE_INPUT)
+                        out << "  Partitioning unknown";
+                    else
+                        out << "  Partitioning finished";
+                    out << " with " << partitions.size() << " partitions." << std::endl;
 
                     if (CONF.dump_partitioning) {
                         std::string part_output_file = CONF.dump_path + "/partitioning-";
@@ -465,12 +849,39 @@ void check_k_fault_resistant_partitioning(std::string config_name)
                     }
                 }
             }
+
+            // The forked process leaves Procedure 1 with its own log
+            if (pipelining && static_cast<uint32_t>(k_faults) < CONF.k) {
+                const std::string log_name = "log-proc2-k" + std::to_string(k_faults);
+                out << "Procedure 2 of order " << k_faults << " started, logged in `" << log_name << "`" << std::endl;
+                out << std::flush;
+                const pid_t pid = fork();
+                if (pid < 0) throw std::logic_error(ILLEGAL_FORK);
+                if (pid == 0) {
+                    prctl(PR_SET_PDEATHSIG, SIGKILL);
+                    out.close();
+                    out.open(CONF.dump_path + "/" + log_name);
+                    pipelined_k = k_faults;
+                    pipelined.clear();
+                    break;
+                }
+                pipelined.emplace(k_faults, std::make_pair(pid, partitions_hash(partitions)));
+            }
+        }
+
+        if (CONF.warm_start && !pipelined_k)
+            out << "Warm start: " << warm_hits << "/" << warm_tries << " queries answered SAT" << std::endl;
+        if (result_cache.enabled() && !pipelined_k) {
+            out << "Result cache: " << result_cache.hits() << "/" << result_cache.lookups();
+            out << " queries answered" << std::endl;
         }
 
         const auto end_proc1{std::chrono::steady_clock::now()};
         uint32_t proc1_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_proc1 - start_proc1).count();
-        out << "=> Procedure 1 verification time: " << proc1_time_ms / 1000;
-        out << "." << (proc1_time_ms % 1000) << " s" << std::endl;
+        if (!pipelined_k) {
+            out << "=> Procedure 1 verification time: " << proc1_time_ms / 1000;
+            out << "." << (proc1_time_ms % 1000) << " s" << std::endl;
+        }
 
         delete cxxsat::solver;
     }
@@ -485,6 +896,48 @@ void check_k_fault_resistant_partitioning(std::string config_name)
         out << std::endl << std::string(80, '*') << std::endl;
         out << std::string(20, ' ') << "Procedure 2 -- Check output integrity";
         out << std::endl << std::string(80, '*') << std::endl;
+
+        // Each split of the fault budget between partitions and comb faults is
+        // an independent output integrity check
+        std::vector<std::pair<uint32_t, uint32_t>> splits;
+        for (uint32_t k_faults = (CONF.increasing_k) ? 1 : CONF.k; k_faults <= CONF.k; k_faults++)
+        {
+            // Set the iteration loop of comb faults to 0 if needed
+            uint32_t max_k_f_comb = (CONF.f_gates == SEQ) ? 0 : k_faults;
+            for (uint32_t k_f_comb = 0; k_f_comb <= max_k_f_comb; k_f_comb++)
+                splits.emplace_back(k_faults, k_f_comb);
+        }
+
+        // A pipelined process checks its own order. Its result holds unless
+        // Procedure 1 merged partitions since, in which case the order is
+        // checked again on the final partitions
+        if (pipelined_k) {
+            std::erase_if(splits, [&](const auto& split) { return split.first != pipelined_k; });
+        }
+        for (auto& [k_faults, child] : pipelined)
+        {
+            if (child.second == partitions_hash(partitions)) {
+                std::erase_if(splits, [&](const auto& split) { return split.first == k_faults; });
+                out << "Order " << k_faults << " checked by pipelined Procedure 2 in `log-proc2-k";
+                out << k_faults << "`" << std::endl;
+            } else {
+                // Its partial log would pass for a result
+                kill(child.first, SIGKILL);
+                waitpid(child.first, nullptr, 0);
+                child.first = 0;
+                std::filesystem::remove(CONF.dump_path + "/log-proc2-k" + std::to_string(k_faults));
+                out << "Partitions merged after order " << k_faults << ", checked again" << std::endl;
+            }
+        }
+
+        // Splits of a work queue are posted once partitions are final
+        if (worker) {
+            partitions = queue.wait_partitions(*circuit);
+            out << "Partitions posted in `" << CONF.work_queue << "`" << std::endl;
+            out << partition_info(*circuit, partitions, CONF.interesting_names).str();
+        } else if (!CONF.work_queue.empty()) {
+            queue.post(partitions, splits.size());
+        }
         
 
         ////////////////////////////////////////////////////////////////////////////
@@ -493,32 +946,50 @@ void check_k_fault_resistant_partitioning(std::string config_name)
         // - Unroll the golden/faulty execution traces
         // - Faults in registers are possible due to their unconstrained initial state
         // - Faults in combinational logic is inserted while unrolling
+        // - With `incremental_unroll`, only the first cycle is unrolled here and
+        //   the next ones are added on demand by the checks below
 
         // Initialize golden/faulty traces which are a sequence of circuit states.
         std::vector<std::unordered_map<signal_id_t, var_t>> golden_trace;
         std::vector<std::unordered_map<signal_id_t, var_t>> faulty_trace;
         std::vector<std::unordered_map<signal_id_t, fault_spec_t>> comb_faults;
+        std::array<std::vector<var_t>, 2> comb_fault_vars;
+
+        // States of the first cycle are referenced below
+        golden_trace.reserve(CONF.delay + 1);
+        faulty_trace.reserve(CONF.delay + 1);
 
         cxxsat::solver = new cxxsat::Solver();
 
-        for (uint32_t cycle = 0; cycle <= CONF.delay; cycle++)
+        // Collect combinational faults at cycle 0 and 1:d
+        auto collect_comb_faults = [&](uint32_t cycle)
         {
-            if (cycle == 0)
-            {
-                unroll_init_with_faults(*circuit, golden_trace, faulty_trace,
-                                        faultable_sigs, comb_faults);
-                // Assume invariant on golden trace
-                assert_invariants_at_step(*circuit, golden_trace, CONF.invariant_list, 0);               
-            } else {
-                unroll_with_faults(*circuit, golden_trace, faulty_trace,
-                                faultable_sigs, comb_faults, alert_signals);
-            }
-
-            // Assume no alert at each step 
-            assert_no_alert_at_step(*circuit, golden_trace, faulty_trace, CONF.alert_list, cycle);
-        }
+            for (const auto& m_sig_fault : comb_faults.at(cycle))
+                comb_fault_vars.at(cycle ? 1 : 0).push_back(m_sig_fault.second.is_faulted());
+        };
 
-        assert(comb_faults.size() == 1 + CONF.delay);
+        auto unroll_next_cycle = [&]()
+        {
+            const uint32_t cycle = golden_trace.size();
+            unroll_cycle(*circuit, golden_trace, faulty_trace, faultable_sigs, comb_faults,
+                         alert_signals, CONF.invariant_list, CONF.alert_list, encoding);
+            collect_comb_faults(cycle);
+        };
+
+        // With `sat_backend`, the queries on the complete unrolling are solved
+        // by the backend on its own copy of the CNF of the unrolling
+        const bool backend_queries = !CONF.sat_backend.empty() && !CONF.incremental_unroll &&
+                                     !CONF.enumerate_minimal;
+        cnf_unrolling_t base_cnf;
+
+        const uint32_t initial_depth = CONF.incremental_unroll ? 0 : CONF.delay;
+        unroll_base(CONF, *circuit, golden_trace, faulty_trace, faultable_sigs, comb_faults,
+                    alert_signals, encoding, initial_depth, out, backend_queries ? &base_cnf : nullptr);
+        assert_mined_invariants(mined_invariants, golden_trace.at(0));
+        for (uint32_t cycle = 0; cycle <= initial_depth; cycle++)
+            collect_comb_faults(cycle);
+
+        assert(comb_faults.size() == 1 + initial_depth);
 
         ////////////////////////////////////////////////////////////////////////////
         //      Build vectors of partition differences at cycle 0
@@ -547,16 +1018,6 @@ void check_k_fault_resistant_partitioning(std::string config_name)
             curr_diff.push_back(cxxsat::solver->make_or(current_partition_diff));
         }
 
-        ////////////////////////////////////////////////////////////////////////////
-        //      Build vectors of combinational faults at cycle 0 and 1:d
-        ////////////////////////////////////////////////////////////////////////////
-        std::array<std::vector<var_t>, 2> comb_fault_vars;
-        for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
-        {
-            for (const auto& m_sig_fault : comb_faults.at(cycle))
-                comb_fault_vars.at(cycle ? 1 : 0).push_back(m_sig_fault.second.is_faulted());
-        }
-
         const auto start_proc2{std::chrono::steady_clock::now()};
 
         // Build set of primary outputs
@@ -580,6 +1041,89 @@ void check_k_fault_resistant_partitioning(std::string config_name)
             output_diff.push_back(var);
         }
 
+        ////////////////////////////////////////////////////////////////////////////
+        //      SAT backend
+        ////////////////////////////////////////////////////////////////////////////
+        // The backend gets the same differences and constraints as the solver,
+        // the clauses added to the solver below being mirrored. Its models are
+        // replayed on the free variables of the solver unrolling
+        std::unique_ptr<SatBackend> backend;
+        cnf_sync_t backend_sync;
+        std::vector<int> backend_part_diff;
+        std::vector<int> backend_comb_faults;
+        std::vector<int> backend_free_lits;
+        std::vector<var_t> replayed_vars;
+        int backend_output_diff = 0;
+        if (backend_queries)
+        {
+            backend = make_backend(CONF.sat_backend);
+            const auto& golden_lits = base_cnf.golden_trace.at(0);
+            const auto& faulty_lits = base_cnf.faulty_trace.at(0);
+
+            // Differences are built in the CNF, then loaded with it
+            cnf_builder = &base_cnf.cnf;
+            std::vector<std::vector<lit_t>> part_diff_lits;
+            for (const auto& partition : partitions)
+            {
+                part_diff_lits.emplace_back();
+                for (const auto& sig : partition)
+                    part_diff_lits.back().push_back(golden_lits.at(sig) ^ faulty_lits.at(sig));
+            }
+            std::vector<lit_t> output_diff_lits;
+            for (const signal_id_t& sig_out : primary_outputs)
+                output_diff_lits.push_back(golden_lits.at(sig_out) ^ faulty_lits.at(sig_out));
+            cnf_builder = nullptr;
+            sync_cnf(base_cnf.cnf, *backend, backend_sync);
+
+            auto to_backend_lits = [&backend_sync](const std::vector<lit_t>& lits)
+            {
+                std::vector<int> backend_lits;
+                for (const lit_t lit : lits) backend_lits.push_back(to_backend(backend_sync, lit));
+                return backend_lits;
+            };
+            for (const auto& diff_lits : part_diff_lits)
+                backend_part_diff.push_back(backend->make_or(to_backend_lits(diff_lits)));
+            backend_output_diff = backend->make_or(to_backend_lits(output_diff_lits));
+
+            for (const reg_clause_t& clause : mined_invariants.clauses)
+            {
+                const lit_t a = golden_lits.at(clause.a);
+                const lit_t b = golden_lits.at(clause.b);
+                backend->add_clause({to_backend(backend_sync, clause.pa ? a : !a),
+                                     to_backend(backend_sync, clause.pb ? b : !b)});
+            }
+
+            for (const auto& cycle_faults : base_cnf.faults)
+            {
+                for (const auto& fault : cycle_faults)
+                    backend_comb_faults.push_back(to_backend(backend_sync, fault.second));
+            }
+            backend_free_lits = to_backend_lits(unrolling_free_lits(*circuit, base_cnf));
+            replayed_vars = unrolling_free_vars(*circuit, golden_trace, faulty_trace, comb_faults);
+            assert(backend_free_lits.size() == replayed_vars.size());
+            out << "  Queries solved by the SAT backend `" << backend->name() << "`" << std::endl;
+        }
+
+        // Solve with the backend under `assumptions`, and replay its model in
+        // the solver under `replay_assumptions`, their counterparts
+        auto check_in_backend = [&](const std::vector<int>& assumptions,
+                                    const std::vector<var_t>& replay_assumptions)
+        {
+            for (const int lit : assumptions) backend->assume(lit);
+            if (backend->check() != cxxsat::Solver::state_t::STATE_SAT)
+                return cxxsat::Solver::state_t::STATE_UNSAT;
+
+            for (const var_t& v : replay_assumptions) cxxsat::solver->assume(v);
+            for (size_t idx = 0; idx < replayed_vars.size(); idx++)
+            {
+                const var_t& v = replayed_vars.at(idx);
+                cxxsat::solver->assume(backend->value(backend_free_lits.at(idx)) ? v : !v);
+            }
+            if (cxxsat::solver->check() != cxxsat::Solver::state_t::STATE_SAT)
+                throw std::logic_error(ILLEGAL_BACKEND_MODEL);
+            return cxxsat::Solver::state_t::STATE_SAT;
+        };
+
         // Data structure to enumerate exploitable partitions/combinational faults
         std::unordered_set<signal_id_t> enumerate_comb_faults;
         std::unordered_set<uint32_t> enumerate_faulty_partitions;
@@ -607,6 +1151,7 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
             if (it == conn_outs.end()) {
                 cxxsat::solver->add_clause(!partitions_diff.at(0).at(part_idx));
+                if (backend) backend->add_clause({-backend_part_diff.at(part_idx)});
                 part_fault_count++;
             }
         }
@@ -628,6 +1173,8 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
             if (it == conn_outs.end()) {
                 cxxsat::solver->add_clause(!sig_fault.second.is_faulted());
+                if (backend)
+                    backend->add_clause({-to_backend(backend_sync, base_cnf.faults.at(0).at(sig_fault.first))});
                 comb_fault_count++;
             }
         }
@@ -635,160 +1182,376 @@ void check_k_fault_resistant_partitioning(std::string config_name)
 
 
 
-        for (uint32_t k_faults = (CONF.increasing_k) ? 1 : CONF.k; k_faults <= CONF.k; k_faults++)
+        auto check_split = [&](uint32_t k_faults, uint32_t k_f_comb, std::ostream& out)
         {
-            // Set the iteration loop of comb faults to 0 if needed
-            uint32_t max_k_f_comb = (CONF.f_gates == SEQ) ? 0 : k_faults;
-            for (uint32_t k_f_comb = 0; k_f_comb <= max_k_f_comb; k_f_comb++)
-            {
-                uint32_t k_f_part = k_faults - k_f_comb;
-
-                out << std::string(80, '-') << std::endl;
-                out << "Check output integrity for " << k_f_part << "/" << partitions.size()
-                    << " faulty partitions," << std::endl;
-                out << k_f_comb << "/" << comb_fault_vars.at(0).size() + comb_fault_vars.at(1).size()
-                    << " combinational faults" << std::endl;
-                out << std::string(80, '-') << std::endl;
+            uint32_t k_f_part = k_faults - k_f_comb;
+
+            out << std::string(80, '-') << std::endl;
+            out << "Check output integrity for " << k_f_part << "/" << partitions.size()
+                << " faulty partitions," << std::endl;
+            out << k_f_comb << "/" << comb_fault_vars.at(0).size() + comb_fault_vars.at(1).size()
+                << " combinational faults" << std::endl;
+            out << std::string(80, '-') << std::endl;
+
+            cxxsat::Solver::state_t res = cxxsat::Solver::state_t::STATE_SAT;
+
+            ///////////////////     ASSUMPTIONS     ///////////////////////
+            // Initially, at most `k_f_comb` comb faults. The constraint is
+            // rebuilt when unrolled cycles bring new comb faults
+            std::vector<var_t> total_comb_f_vars;
+            var_t at_most_k_f_comb = var_t::ONE;
+            size_t counted_comb_f_vars = SIZE_MAX;
+
+            // Initially, at most `k_f_part` partitions faulted
+            var_t at_most_k_f_part = cxxsat::solver->make_at_most(partitions_diff.at(0), k_f_part);
+
+            // At least on faulty primary output
+            var_t at_most_1_f_output = cxxsat::solver->make_or(output_diff);
+
+            // Same constraints in the backend, whose unrolling is complete
+            int backend_at_most_k_f_comb = 0;
+            int backend_at_most_k_f_part = 0;
+            if (backend) {
+                backend_at_most_k_f_comb = backend->make_at_most(backend_comb_faults, k_f_comb);
+                backend_at_most_k_f_part = backend->make_at_most(backend_part_diff, k_f_part);
+            }
 
-                cxxsat::Solver::state_t res = cxxsat::Solver::state_t::STATE_SAT;
+            auto check_with_assumptions = [&](const std::vector<var_t>& extra)
+            {
+                const size_t num_comb_f_vars = comb_fault_vars.at(0).size() + comb_fault_vars.at(1).size();
+                if (num_comb_f_vars != counted_comb_f_vars)
+                {
+                    total_comb_f_vars = comb_fault_vars.at(0);
+                    total_comb_f_vars.insert(total_comb_f_vars.end(),
+                            comb_fault_vars.at(1).begin(), comb_fault_vars.at(1).end());
+                    at_most_k_f_comb = cxxsat::solver->make_at_most(total_comb_f_vars, k_f_comb);
+                    counted_comb_f_vars = num_comb_f_vars;
+                }
 
-                ///////////////////     ASSUMPTIONS     ///////////////////////
-                std::vector<var_t> total_comb_f_vars(comb_fault_vars.at(0));
-                total_comb_f_vars.insert(total_comb_f_vars.end(),
-                        comb_fault_vars.at(1).begin(), comb_fault_vars.at(1).end());
+                // A query decided by an earlier run is only replayed. Queries of
+                // the enumeration block models with assumptions of their own
+                const bool caching = result_cache.enabled() && extra.empty() && !CONF.enumerate_minimal;
+                std::string query_key;
+                std::vector<var_t> cache_vars;
+                if (caching) {
+                    std::unordered_set<signal_id_t> blocked_partitions;
+                    for (const uint32_t idx : enumerate_faulty_partitions)
+                        blocked_partitions.insert(partitions.at(idx).begin(), partitions.at(idx).end());
+
+                    std::stringstream key;
+                    key << result_cache_key(CONF, *circuit, faultable_sigs, partitions, golden_trace.size() - 1);
+                    key << " proc2 k " << k_faults << " comb " << k_f_comb << std::hex;
+                    key << " blocked " << signals_hash(enumerate_comb_faults) << " " << signals_hash(blocked_partitions);
+                    query_key = key.str();
+                    cache_vars = unrolling_free_vars(*circuit, golden_trace, faulty_trace, comb_faults);
+
+                    cxxsat::Solver::state_t res;
+                    if (result_cache.lookup(query_key, {at_most_k_f_comb, at_most_k_f_part, at_most_1_f_output},
+                                            cache_vars, res)) {
+                        out << "(cached) " << std::flush;
+                        return res;
+                    }
+                }
 
-                // Initially, at most `k_f_comb` comb faults
-                var_t at_most_k_f_comb = cxxsat::solver->make_at_most(total_comb_f_vars, k_f_comb);
+                if (backend) {
+                    const cxxsat::Solver::state_t res = check_in_backend(
+                        {backend_at_most_k_f_comb, backend_at_most_k_f_part, backend_output_diff},
+                        {at_most_k_f_comb, at_most_k_f_part, at_most_1_f_output});
+                    if (caching) result_cache.store(query_key, res, cache_vars);
+                    return res;
+                }
 
-                // Initially, at most `k_f_part` partitions faulted
-                var_t at_most_k_f_part = cxxsat::solver->make_at_most(partitions_diff.at(0), k_f_part);
+                std::vector<var_t> model_vars;
+                if (CONF.portfolio > 1 || CONF.query_timeout)
+                    model_vars = unrolling_free_vars(*circuit, golden_trace, faulty_trace, comb_faults);
+                const cxxsat::Solver::state_t res = check_escalating(CONF.portfolio, CONF.query_timeout * 1000,
+                    [&](bool seq_counter)
+                    {
+                        std::vector<var_t> assumptions = {at_most_k_f_comb, at_most_k_f_part, at_most_1_f_output};
+                        if (seq_counter) {
+                            assumptions.at(0) = make_seq_at_most(total_comb_f_vars, k_f_comb);
+                            assumptions.at(1) = make_seq_at_most(partitions_diff.at(0), k_f_part);
+                        }
+                        assumptions.insert(assumptions.end(), extra.begin(), extra.end());
+                        return assumptions;
+                    }, model_vars, out);
+                if (caching) result_cache.store(query_key, res, cache_vars);
+                return res;
+            };
+
+            // Minimal fault sets are enumerated on the complete unrolling,
+            // projected on comb faults and initial partition differences
+            if (CONF.enumerate_minimal)
+            {
+                while (golden_trace.size() <= CONF.delay)
+                    unroll_next_cycle();
 
-                // At least on faulty primary output
-                var_t at_most_1_f_output = cxxsat::solver->make_or(output_diff);
-                for (;solver_iter<MAX_ITER; solver_iter++)
+                std::vector<var_t> projection;
+                std::vector<std::pair<uint32_t, signal_id_t>> projected_faults;
+                for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
                 {
-                    // Assumptions
-                    cxxsat::solver->assume(at_most_k_f_comb);
-                    cxxsat::solver->assume(at_most_k_f_part);
-                    cxxsat::solver->assume(at_most_1_f_output);
-
-                    // Assume no comb faults that we already enumerated
-                    out << std::endl << "Enumerate exploitable faults: ";
-                    for (const signal_id_t& sig : enumerate_comb_faults)
+                    for (const auto& fault : comb_faults.at(cycle))
                     {
-                        out << static_cast<uint32_t>(sig) << " ";
-                        const auto& f = comb_faults.at(0).find(sig);
-                        assert(f != comb_faults.at(0).end());
-                        cxxsat::solver->add_clause(!f->second.is_faulted());
+                        projection.push_back(fault.second.is_faulted());
+                        projected_faults.emplace_back(cycle, fault.first);
                     }
-                    out << std::endl;
+                }
+                projection.insert(projection.end(), partitions_diff.at(0).begin(), partitions_diff.at(0).end());
 
-                    // Assume no faulty partitions that we already enumerated
-                    out << "Enumerate exploitable partitions: ";
-                    for (const uint32_t& idx : enumerate_faulty_partitions)
+                out << std::endl << "  Enumerating minimal fault sets" << std::endl;
+                const auto start_enum{std::chrono::steady_clock::now()};
+                const enumeration_t enumeration = enumerate_minimal_sets(projection,
+                    [&](const std::vector<var_t>& extra) { return check_with_assumptions(extra); },
+                    [&](const std::vector<uint32_t>& set)
                     {
-                        out << idx << " ";
-                        const var_t& v = partitions_diff.at(0).at(idx);
-                        cxxsat::solver->add_clause(!v);
-                    }
-                    out << std::endl;
+                        out << "  - Fault set: ";
+                        for (const uint32_t idx : set)
+                        {
+                            if (idx < projected_faults.size()) {
+                                out << "comb " << static_cast<uint32_t>(projected_faults.at(idx).second);
+                                out << " (cycle " << projected_faults.at(idx).first << ") ";
+                            } else {
+                                out << "partition " << idx - projected_faults.size() << " ";
+                            }
+                        }
+                        out << std::endl << "    Corrupted outputs: ";
+                        const std::vector<signal_id_t> outs(circuit->outs().begin(), circuit->outs().end());
+                        const model_t golden_outs = read_state(golden_state, outs);
+                        const model_t faulty_outs = read_state(faulty_state, outs);
+                        for (uint32_t idx = 0; idx < outs.size(); idx++)
+                        {
+                            if (golden_outs[idx] != faulty_outs[idx])
+                                out << static_cast<uint32_t>(outs.at(idx)) << " ";
+                        }
+                        out << std::endl;
+                        return ++solver_iter < MAX_ITER;
+                    });
+                const auto end_enum{std::chrono::steady_clock::now()};
+
+                uint32_t enum_time_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end_enum - start_enum).count();
+                out << "  " << enumeration.sets << " minimal fault sets, " << enumeration.checks << " checks, ";
+                out << enum_time_ms / 1000 << "." << (enum_time_ms % 1000) << " s";
+                if (!enumeration.complete) out << " (incomplete)";
+                if (!enumeration.minimal) out << " (some sets may not be minimal)";
+                out << std::endl;
+                return;
+            }
+
+            for (;solver_iter<MAX_ITER; solver_iter++)
+            {
+                // Assume no comb faults that we already enumerated
+                out << std::endl << "Enumerate exploitable faults: ";
+                for (const signal_id_t& sig : enumerate_comb_faults)
+                {
+                    out << static_cast<uint32_t>(sig) << " ";
+                    const auto& f = comb_faults.at(0).find(sig);
+                    assert(f != comb_faults.at(0).end());
+                    cxxsat::solver->add_clause(!f->second.is_faulted());
+                    if (backend)
+                        backend->add_clause({-to_backend(backend_sync, base_cnf.faults.at(0).at(sig))});
+                }
+                out << std::endl;
 
-                    out << std::endl << "  Running solver " << solver_iter << ": " << std::flush;
+                // Assume no faulty partitions that we already enumerated
+                out << "Enumerate exploitable partitions: ";
+                for (const uint32_t& idx : enumerate_faulty_partitions)
+                {
+                    out << idx << " ";
+                    const var_t& v = partitions_diff.at(0).at(idx);
+                    cxxsat::solver->add_clause(!v);
+                    if (backend) backend->add_clause({-backend_part_diff.at(idx)});
+                }
+                out << std::endl;
 
-                    const auto start_check{std::chrono::steady_clock::now()};
-                    res = cxxsat::solver->check();
-                    const auto end_check{std::chrono::steady_clock::now()};
-                    
-                    const std::chrono::duration check_time = end_check - start_check;
-                    uint32_t check_time_ms =
-                        std::chrono::duration_cast<std::chrono::milliseconds>(check_time).count();
+                out << std::endl << "  Running solver " << solver_iter << ": " << std::flush;
 
-                    if (res == cxxsat::Solver::state_t::STATE_UNSAT)
-                    {
-                        out << "UNSAT " << check_time_ms / 1000 << "." << (check_time_ms % 1000)
-                            << " s" << std::endl;
-                        break;
-                    }
+                const auto start_check{std::chrono::steady_clock::now()};
+                res = check_with_assumptions({});
 
-                    out << "SAT " << check_time_ms / 1000 << "."
-                        << (check_time_ms % 1000) << " s" << std::endl;
+                // Incremental unrolling. The unrolled cycles are a relaxation
+                // of the full trace, so UNSAT holds for any delay. On SAT, the
+                // next cycle is added until `delay`: deeper cycles still forbid
+                // alerts, golden ones included, and may refute the solution
+                while (CONF.incremental_unroll &&
+                       res == cxxsat::Solver::state_t::STATE_SAT &&
+                       golden_trace.size() <= CONF.delay)
+                {
+                    unroll_next_cycle();
+                    res = check_with_assumptions({});
+                }
+                const auto end_check{std::chrono::steady_clock::now()};
 
-                    // Show comb gates initially faulty
-                    {
-                        for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
-                        {
-                            std::vector<signal_id_t> faulty_sig_comb;
-                            for (const auto& fault : comb_faults.at(cycle))
-                            {
-                                if (cxxsat::solver->value(fault.second.f0))
-                                {
-                                    faulty_sig_comb.push_back(fault.first);
-                                    enumerate_comb_faults.emplace(fault.first);
-                                }
-                            }
-                            assert(faulty_sig_comb.size() <= k_f_comb);
+                const std::chrono::duration check_time = end_check - start_check;
+                uint32_t check_time_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(check_time).count();
 
-                            out << "Faulty comb gates at clock cycle " << cycle << ": ";
-                            for (const signal_id_t sig : faulty_sig_comb)
-                            {
-                                out << static_cast<uint32_t>(sig) << " ";
-                            }
-                            out << std::endl;
-                        }
-                    }
+                if (res == cxxsat::Solver::state_t::STATE_UNSAT)
+                {
+                    out << "UNSAT " << check_time_ms / 1000 << "." << (check_time_ms % 1000)
+                        << " s" << std::endl;
+                    if (CONF.incremental_unroll)
+                        out << "  Unrolled cycles: " << golden_trace.size() - 1 << "/" << CONF.delay << std::endl;
+                    break;
+                }
 
-                    // Show partitions initially faulted
-                    std::vector<uint32_t> faulty_indexes_initial;
-                    {
-                        const auto& initial_part_diff = partitions_diff.at(0);
+                // Every escalation timed out, the split stays unknown
+                if (res == cxxsat::Solver::state_t::STATE_INPUT)
+                {
+                    out << "UNKNOWN " << check_time_ms / 1000 << "." << (check_time_ms % 1000)
+                        << " s" << std::endl;
+                    break;
+                }
+
+                out << "SAT " << check_time_ms / 1000 << "."
+                    << (check_time_ms % 1000) << " s" << std::endl;
+                if (CONF.incremental_unroll)
+                    out << "  Unrolled cycles: " << golden_trace.size() - 1 << "/" << CONF.delay << std::endl;
 
-                        for (uint32_t part_idx = 0; part_idx < initial_part_diff.size(); part_idx++)
+                // Read the faults and outputs of the counterexample at once
+                std::vector<var_t> readout;
+                for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
+                {
+                    for (const auto& fault : comb_faults.at(cycle))
+                        readout.push_back(fault.second.f0);
+                }
+                const size_t diff0_beg = readout.size();
+                readout.insert(readout.end(), partitions_diff.at(0).begin(), partitions_diff.at(0).end());
+                const model_t model(readout);
+                const std::vector<signal_id_t> outs(circuit->outs().begin(), circuit->outs().end());
+                const model_t golden_outs = read_state(golden_state, outs);
+                const model_t faulty_outs = read_state(faulty_state, outs);
+
+                // Show comb gates initially faulty
+                {
+                    size_t fault_pos = 0;
+                    for (uint32_t cycle = 0; cycle < comb_faults.size(); cycle++)
+                    {
+                        std::vector<signal_id_t> faulty_sig_comb;
+                        for (const auto& fault : comb_faults.at(cycle))
                         {
-                            const var_t& s = initial_part_diff.at(part_idx);
-                            if (cxxsat::solver->value(s))
+                            if (model[fault_pos++])
                             {
-                                faulty_indexes_initial.push_back(part_idx);
-                                enumerate_faulty_partitions.emplace(part_idx);
+                                faulty_sig_comb.push_back(fault.first);
+                                enumerate_comb_faults.emplace(fault.first);
                             }
                         }
-                        assert(faulty_indexes_initial.size() <= k_f_part);
+                        assert(faulty_sig_comb.size() <= k_f_comb);
 
-                        out << "Faulty partitions (initial): ";
-                        for (uint32_t idx : faulty_indexes_initial)
+                        out << "Faulty comb gates at clock cycle " << cycle << ": ";
+                        for (const signal_id_t sig : faulty_sig_comb)
                         {
-                            out << idx << " ( ";
-                            for (const auto r : partitions.at(idx))
-                            { out << static_cast<uint32_t>(r) << " "; }
-                            out << ") ";
+                            out << static_cast<uint32_t>(sig) << " ";
                         }
                         out << std::endl;
                     }
+                }
+
+                // Show partitions initially faulted
+                std::vector<uint32_t> faulty_indexes_initial = model.true_indexes(diff0_beg, model.size());
+                {
+                    enumerate_faulty_partitions.insert(faulty_indexes_initial.begin(), faulty_indexes_initial.end());
+                    assert(faulty_indexes_initial.size() <= k_f_part);
 
-                    // Show corrupted outputs
+                    out << "Faulty partitions (initial): ";
+                    for (uint32_t idx : faulty_indexes_initial)
                     {
-                        out << "Corrupted outputs: ";
-                        for (const signal_id_t& sig_out : circuit->outs())
-                        {
-                            const auto& it_g = golden_state.find(sig_out);
-                            const auto& it_f = faulty_state.find(sig_out);
-                            assert(it_g != golden_state.end());
-                            assert(it_f != faulty_state.end());
-                            if (cxxsat::solver->value(it_g->second) != cxxsat::solver->value(it_f->second))
-                                out << static_cast<uint32_t>(sig_out) << " ";
-                        }
-                        out << std::endl;
+                        out << idx << " ( ";
+                        for (const auto r : partitions.at(idx))
+                        { out << static_cast<uint32_t>(r) << " "; }
+                        out << ") ";
                     }
+                    out << std::endl;
+                }
 
-                    if (CONF.dump_vcd)
+                // Show corrupted outputs
+                {
+                    out << "Corrupted outputs: ";
+                    for (uint32_t idx = 0; idx < outs.size(); idx++)
                     {
-                        std::string fname = CONF.dump_path + "/k-partitions-output-";
-                        fname += time_str;
-                        fname += ".vcd";
-                        dump_vcd(fname, *circuit, golden_trace, faulty_trace);
+                        assert(golden_state.find(outs.at(idx)) != golden_state.end());
+                        assert(faulty_state.find(outs.at(idx)) != faulty_state.end());
+                        if (golden_outs[idx] != faulty_outs[idx])
+                            out << static_cast<uint32_t>(outs.at(idx)) << " ";
                     }
+                    out << std::endl;
+                }
+
+                if (CONF.dump_vcd)
+                {
+                    std::string fname = CONF.dump_path + "/k-partitions-output-";
+                    fname += time_str;
+                    fname += ".vcd";
+                    dump_vcd(fname, *circuit, golden_trace, faulty_trace);
+                }
 
-                }                        
             }
+        };
+
+        if (!CONF.work_queue.empty()) {
+            // Coordinator and workers claim splits until none is pending, each
+            // checked in a forked process from the state reached here
+            auto check_claimed_splits = [&]()
+            {
+                uint32_t split_idx;
+                while (queue.claim(split_idx))
+                {
+                    std::string split_log;
+                    const pid_t keeper = queue.keep_alive(split_idx);
+                    run_forked(1, 1,
+                        [&](uint32_t)
+                        {
+                            std::stringstream ss;
+                            check_split(splits.at(split_idx).first, splits.at(split_idx).second, ss);
+                            return ss.str();
+                        },
+                        [&](uint32_t, const std::string& log)
+                        {
+                            split_log = log;
+                            return false;
+                        });
+                    queue.release(keeper);
+                    queue.complete(split_idx, split_log);
+                    if (worker) out << split_log << std::flush;
+                }
+            };
+            check_claimed_splits();
+
+            // Splits of dead workers are checked again
+            if (!worker) {
+                for (uint32_t split_idx = 0; split_idx < splits.size(); split_idx++)
+                    out << queue.wait_result(split_idx, check_claimed_splits) << std::flush;
+                queue.retire();
+            }
+        } else if (CONF.parallel_splits <= 1) {
+            for (const auto& [k_faults, k_f_comb] : splits)
+                check_split(k_faults, k_f_comb, out);
+        } else {
+            // Splits run in forked workers from the state reached here, each
+            // enumerating on its own, and their logs follow the order of splits
+            std::vector<std::string> split_logs(splits.size());
+            run_forked(splits.size(), CONF.parallel_splits,
+                [&](uint32_t split_idx)
+                {
+                    std::stringstream ss;
+                    check_split(splits.at(split_idx).first, splits.at(split_idx).second, ss);
+                    return ss.str();
+                },
+                [&](uint32_t split_idx, const std::string& log)
+                {
+                    split_logs.at(split_idx) = log;
+                    return false;
+                });
+            for (const std::string& log : split_logs) out << log;
+        }
+
+        for (const auto& [k_faults, child] : pipelined)
+        {
+            if (child.first == 0) continue;
+            int status = 0;
+            waitpid(child.first, &status, 0);
+            const bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            out << "Pipelined Procedure 2 of order " << k_faults << (ok ? " done" : " FAILED") << std::endl;
         }
 
         const auto end_proc2{std::chrono::steady_clock::now()};
@@ -799,16 +1562,69 @@ void check_k_fault_resistant_partitioning(std::string config_name)
         delete cxxsat::solver;
     }
     out.close();
-    delete circuit;
+    if (circuit != design) delete circuit;
+
+    // A pipelined process never returns to the caller of its parent
+    if (pipelined_k) _exit(0);
 }
 
 int main(int argc, char* argv[])
 {
     std::string config_name = "default";
 
-    if (argc == 2)
+    // Batch of configurations: --batch [--jobs N] [--mem MB] pattern...
+    if (argc >= 2 && std::string(argv[1]) == "--batch") {
+        uint32_t max_jobs = std::thread::hardware_concurrency();
+        uint64_t mem_budget_mb = available_memory_mb();
+        std::vector<std::string> patterns;
+        for (int idx = 2; idx < argc; idx++)
+        {
+            const std::string arg = argv[idx];
+            if (arg == "--jobs" && idx + 1 < argc)
+                max_jobs = std::stoul(argv[++idx]);
+            else if (arg == "--mem" && idx + 1 < argc)
+                mem_budget_mb = std::stoull(argv[++idx]);
+            else
+                patterns.push_back(arg);
+        }
+
+        const std::vector<batch_job_t> jobs = match_configs("config/config_file.json", patterns);
+        const uint32_t failed = run_batch(jobs, max_jobs, mem_budget_mb,
+            [](const std::string& name, Circuit* design)
+                { check_k_fault_resistant_partitioning(name, false, design); },
+            std::cout);
+        std::cout << jobs.size() - failed << "/" << jobs.size() << " configurations done" << std::endl;
+        return failed ? 1 : 0;
+    }
+
+    // Resident analysis service: --daemon <socket> [--cache DIR]
+    if (argc >= 3 && std::string(argv[1]) == "--daemon") {
+        const std::string cache_dir = (argc == 5 && std::string(argv[3]) == "--cache") ? argv[4] : "";
+        run_daemon(argv[2], "config/config_file.json", cache_dir,
+            [](const std::string& name, const nlohmann::json& overrides, Circuit* design)
+                { check_k_fault_resistant_partitioning(name, false, design, overrides); },
+            std::cout);
+        return 0;
+    }
+
+    // Request to a daemon: --request <socket> <config> [overrides] or --request <socket> --stop
+    if (argc >= 4 && std::string(argv[1]) == "--request") {
+        nlohmann::json request;
+        if (std::string(argv[3]) == "--stop") {
+            request["stop"] = true;
+        } else {
+            request["config"] = argv[3];
+            if (argc >= 5) request["overrides"] = nlohmann::json::parse(argv[4]);
+        }
+        return send_request(argv[2], request, std::cout) ? 0 : 1;
+    }
+
+    if (argc >= 2)
         config_name = argv[1];
 
-    check_k_fault_resistant_partitioning(config_name);
+    // Join the work queue of a coordinator running the same configuration
+    const bool worker = argc == 3 && std::string(argv[2]) == "--worker";
+
+    check_k_fault_resistant_partitioning(config_name, worker);
     return 0;
 }
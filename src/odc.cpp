@@ -0,0 +1,203 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include "odc.h"
+#include "Simulator.h"
+#include "utils.h"
+
+using sim_state_t = std::unordered_map<signal_id_t, sim_word_t>;
+
+// Re-evaluate the cone with `site` flipped in every simulated state
+static bool observed_in_simulation(signal_id_t site, const std::vector<const Cell*>& cone,
+                                   const std::unordered_set<signal_id_t>& observed_sigs,
+                                   const std::vector<sim_state_t>& states,
+                                   const std::vector<sim_state_t>& next_states)
+{
+    const sim_state_t empty;
+    for (uint32_t word = 0; word < states.size(); word++)
+    {
+        const sim_state_t& state = states.at(word);
+        sim_state_t local_state;
+        sim_state_t local_next_state;
+        local_state.emplace(site, !state.at(site));
+
+        for (const Cell* cell : cone)
+        {
+            for (signal_id_t in : cell_inputs(cell))
+                local_state.emplace(in, state.at(in));
+
+            if (is_register(cell->type())) {
+                const signal_id_t out_q = cell->ports().m_dff.m_out_q;
+                local_state.emplace(out_q, state.at(out_q));
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(local_state, local_next_state);
+                if (!(local_next_state.at(out_q) == next_states.at(word).at(out_q))) return true;
+            } else {
+                const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(empty, local_state);
+                if (observed_sigs.find(out_y) != observed_sigs.end() &&
+                    !(local_state.at(out_y) == state.at(out_y))) return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*  Encode the cone twice, with and without the bit-flip of `site`. Both copies
+ *  share the boundary of the cone and the bit-flips of its faultable gates
+ */
+static bool observable_by_sat(signal_id_t site, const std::vector<const Cell*>& cone,
+                              const std::unordered_set<signal_id_t>& faultable_sigs,
+                              const std::unordered_set<signal_id_t>& observed_sigs)
+{
+    cxxsat::Solver* const analysis_solver = cxxsat::solver;
+    cxxsat::solver = new cxxsat::Solver();
+
+    std::array<std::unordered_map<signal_id_t, var_t>, 2> states;
+    std::array<std::unordered_map<signal_id_t, var_t>, 2> next_states;
+    const var_t site_var = cxxsat::solver->new_var();
+    for (uint32_t flip = 0; flip <= 1; flip++)
+    {
+        init_constants(states.at(flip));
+        states.at(flip).emplace(site, flip ? !site_var : site_var);
+    }
+
+    const std::unordered_map<signal_id_t, var_t> empty;
+    std::vector<var_t> diffs;
+    for (const Cell* cell : cone)
+    {
+        std::vector<signal_id_t> ins = cell_inputs(cell);
+        if (is_register(cell->type())) ins.push_back(cell->ports().m_dff.m_out_q);
+        for (signal_id_t in : ins)
+        {
+            if (states.at(0).find(in) != states.at(0).end()) continue;
+            const var_t var = cxxsat::solver->new_var();
+            for (auto& state : states)
+                state.emplace(in, var);
+        }
+
+        if (is_register(cell->type())) {
+            const signal_id_t out_q = cell->ports().m_dff.m_out_q;
+            for (uint32_t flip = 0; flip <= 1; flip++)
+                cell->eval<var_t, var_t&, make_const<var_t>>(states.at(flip), next_states.at(flip));
+            diffs.push_back(next_states.at(0).at(out_q) ^ next_states.at(1).at(out_q));
+            continue;
+        }
+
+        const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+        for (auto& state : states)
+            cell->eval<var_t, var_t&, make_const<var_t>>(empty, state);
+        if (faultable_sigs.find(out_y) != faultable_sigs.end()) {
+            const var_t f = cxxsat::solver->new_var();
+            for (auto& state : states)
+                state.at(out_y) = state.at(out_y) ^ f;
+        }
+        if (observed_sigs.find(out_y) != observed_sigs.end())
+            diffs.push_back(states.at(0).at(out_y) ^ states.at(1).at(out_y));
+    }
+
+    bool observable = false;
+    if (!diffs.empty()) {
+        cxxsat::solver->assume(cxxsat::solver->make_or(diffs));
+        observable = cxxsat::solver->check() == cxxsat::Solver::state_t::STATE_SAT;
+    }
+
+    delete cxxsat::solver;
+    cxxsat::solver = analysis_solver;
+    return observable;
+}
+
+odc_pruning_t compute_odc_pruning(const Circuit& circuit,
+                                  const std::unordered_set<signal_id_t>& faultable_sigs,
+                                  const std::unordered_set<signal_id_t>& observed_sigs)
+{
+    odc_pruning_t odc_pruning;
+    const Simulator simulator(circuit);
+
+    // Random states of the whole circuit, registers being free
+    std::vector<signal_id_t> free_sigs(circuit.ins().begin(), circuit.ins().end());
+    free_sigs.insert(free_sigs.end(), circuit.regs().begin(), circuit.regs().end());
+    std::sort(free_sigs.begin(), free_sigs.end());
+
+    std::mt19937_64 rng(42);
+    const sim_state_t empty;
+    std::vector<sim_state_t> states(ODC_SIM_WORDS);
+    std::vector<sim_state_t> next_states(ODC_SIM_WORDS);
+    for (uint32_t word = 0; word < ODC_SIM_WORDS; word++)
+    {
+        sim_state_t& state = states.at(word);
+        state.emplace(signal_id_t::S_0, sim_from_bool(false));
+        state.emplace(signal_id_t::S_1, sim_from_bool(true));
+        state.emplace(signal_id_t::S_X, sim_from_bool(false));
+        state.emplace(signal_id_t::S_Z, sim_from_bool(false));
+        for (signal_id_t sig : free_sigs) state.emplace(sig, sim_word_t(rng()));
+
+        for (const Cell* cell : circuit.cells())
+        {
+            if (!is_register(cell->type()))
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(empty, state);
+        }
+        for (const Cell* cell : circuit.cells())
+        {
+            if (is_register(cell->type()))
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(state, next_states.at(word));
+        }
+    }
+
+    // Faultable inputs and gate outputs
+    std::vector<signal_id_t> sites;
+    for (signal_id_t sig : faultable_sigs)
+    {
+        if (is_constant(sig)) continue;
+        const Cell* cell = simulator.driver(sig);
+        if (cell == nullptr ? circuit.ins().find(sig) != circuit.ins().end() : !is_register(cell->type()))
+            sites.push_back(sig);
+    }
+    std::sort(sites.begin(), sites.end());
+
+    for (signal_id_t site : sites)
+    {
+        odc_pruning.sites++;
+        if (observed_sigs.find(site) != observed_sigs.end()) continue;
+
+        std::vector<const Cell*> cone;
+        if (!simulator.fanout_cone(site, ODC_MAX_CONE, cone)) {
+            odc_pruning.large_cones++;
+            continue;
+        }
+        if (observed_in_simulation(site, cone, observed_sigs, states, next_states)) {
+            odc_pruning.simulated++;
+            continue;
+        }
+        odc_pruning.checked++;
+        if (!observable_by_sat(site, cone, faultable_sigs, observed_sigs))
+            odc_pruning.pruned.emplace(site);
+    }
+    return odc_pruning;
+}
+
+std::stringstream odc_pruning_info(const odc_pruning_t& odc_pruning)
+{
+    std::stringstream ss;
+    ss << "******* ODC pruning ********" << std::endl;
+    ss << "Fault sites: " << odc_pruning.sites << std::endl;
+    ss << "Kept with large cones: " << odc_pruning.large_cones << std::endl;
+    ss << "Observed in simulation: " << odc_pruning.simulated << std::endl;
+    ss << "Checked with SAT: " << odc_pruning.checked << std::endl;
+    ss << "Pruned: " << odc_pruning.pruned.size() << std::endl;
+    return ss;
+}
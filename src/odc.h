@@ -0,0 +1,54 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_ODC_H
+#define VERIFIER_ODC_H
+
+#include <sstream>
+#include <unordered_set>
+
+#include "Circuit.h"
+
+// Number of 64-bit words of random patterns simulated per fault site
+#define ODC_SIM_WORDS 16
+// Fault sites with a larger fanout cone (in cells) are kept without analysis
+#define ODC_MAX_CONE 2000
+
+///////////   Odc_pruning_t   //////////////////////////////////////////////////
+// Combinational fault sites whose bit-flip never reaches a register, an
+// output or an observed signal, whatever the other faults of the same cycle
+
+struct odc_pruning_t
+{
+    std::unordered_set<signal_id_t> pruned;
+    uint32_t sites = 0;
+    uint32_t large_cones = 0;
+    uint32_t simulated = 0;
+    uint32_t checked = 0;
+};
+
+/*  Find the unobservable sites among the faultable inputs and gate outputs.
+ *  A site is observable if flipping it changes the next value of a register or
+ *  a signal of `observed_sigs` for some values of the boundary of its fanout
+ *  cone and some flips of the faultable gates of the cone:
+ *  - random simulation of the whole circuit first shows observable sites
+ *  - a local SAT check on the fanout cone then proves the others
+ */
+odc_pruning_t compute_odc_pruning(const Circuit& circuit,
+                                  const std::unordered_set<signal_id_t>& faultable_sigs,
+                                  const std::unordered_set<signal_id_t>& observed_sigs);
+
+std::stringstream odc_pruning_info(const odc_pruning_t& odc_pruning);
+
+#endif // VERIFIER_ODC_H
@@ -0,0 +1,358 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "parallel.h"
+#include "utils.h"
+
+struct worker_t
+{
+    pid_t pid;
+    int fd;
+    uint32_t job;
+    std::string data;
+};
+
+static void write_all(int fd, const std::string& data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        const ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) _exit(1);
+        written += n;
+    }
+}
+
+static void kill_workers(std::vector<worker_t>& workers)
+{
+    for (const worker_t& worker : workers)
+    {
+        kill(worker.pid, SIGKILL);
+        close(worker.fd);
+        waitpid(worker.pid, nullptr, 0);
+    }
+    workers.clear();
+}
+
+bool run_forked(uint32_t num_jobs, uint32_t max_workers,
+                const worker_job_t& job, const worker_result_t& on_result,
+                uint32_t timeout_ms)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    std::vector<worker_t> workers;
+    uint32_t next_job = 0;
+    bool stop = false;
+
+    while (!stop && (next_job < num_jobs || !workers.empty()))
+    {
+        while (next_job < num_jobs && workers.size() < std::max(max_workers, uint32_t(1)))
+        {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                kill_workers(workers);
+                throw std::logic_error(ILLEGAL_FORK);
+            }
+            const pid_t pid = fork();
+            if (pid < 0) {
+                close(fds[0]);
+                close(fds[1]);
+                kill_workers(workers);
+                throw std::logic_error(ILLEGAL_FORK);
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                int status = 1;
+                try {
+                    write_all(fds[1], job(next_job));
+                    status = 0;
+                } catch (...) {}
+                _exit(status);
+            }
+            close(fds[1]);
+            workers.push_back({pid, fds[0], next_job++, ""});
+        }
+
+        std::vector<pollfd> polled;
+        for (const worker_t& worker : workers)
+            polled.push_back({worker.fd, POLLIN, 0});
+        int poll_ms = -1;
+        if (timeout_ms) {
+            const auto left = deadline - std::chrono::steady_clock::now();
+            poll_ms = std::chrono::duration_cast<std::chrono::milliseconds>(left).count();
+            if (poll_ms <= 0) {
+                kill_workers(workers);
+                return false;
+            }
+        }
+        if (poll(polled.data(), polled.size(), poll_ms) < 0) {
+            if (errno == EINTR) continue;
+            kill_workers(workers);
+            throw std::logic_error(ILLEGAL_WORKER_EXIT);
+        }
+
+        // Backwards, as finished workers are removed
+        for (size_t idx = workers.size(); idx-- > 0 && !stop;)
+        {
+            if (polled.at(idx).revents == 0) continue;
+            worker_t& worker = workers.at(idx);
+            char buffer[1 << 16];
+            const ssize_t n = read(worker.fd, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n > 0) {
+                worker.data.append(buffer, n);
+                continue;
+            }
+
+            int status = 0;
+            close(worker.fd);
+            waitpid(worker.pid, &status, 0);
+            const uint32_t finished_job = worker.job;
+            const std::string data = std::move(worker.data);
+            workers.erase(workers.begin() + idx);
+            if (n < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                kill_workers(workers);
+                throw std::logic_error(ILLEGAL_WORKER_EXIT);
+            }
+            stop = on_result(finished_job, data);
+        }
+    }
+    kill_workers(workers);
+    return true;
+}
+
+// Answer of a worker: 'U' on UNSAT, 'S' then the value of each model variable on SAT
+static std::string solve_in_worker(const std::vector<var_t>& assumptions,
+                                   const std::vector<var_t>& model_vars)
+{
+    for (const var_t& v : assumptions) cxxsat::solver->assume(v);
+    if (cxxsat::solver->check() != cxxsat::Solver::state_t::STATE_SAT)
+        return std::string("U");
+
+    const model_t values(model_vars);
+    std::string model("S");
+    for (size_t idx = 0; idx < values.size(); idx++)
+        model.push_back(values[idx] ? '1' : '0');
+    return model;
+}
+
+static cxxsat::Solver::state_t replay_answer(const std::string& answer,
+                                             const std::vector<var_t>& assumptions,
+                                             const std::vector<var_t>& model_vars)
+{
+    if (answer.empty() || answer.size() != 1 + (answer.front() == 'S' ? model_vars.size() : 0))
+        throw std::logic_error(ILLEGAL_WORKER_EXIT);
+    if (answer.front() == 'U') return cxxsat::Solver::state_t::STATE_UNSAT;
+
+    // Only propagation is left to the parent solver
+    for (const var_t& v : assumptions) cxxsat::solver->assume(v);
+    for (size_t idx = 0; idx < model_vars.size(); idx++)
+        cxxsat::solver->assume(answer.at(idx + 1) == '1' ? model_vars.at(idx) : !model_vars.at(idx));
+    if (cxxsat::solver->check() != cxxsat::Solver::state_t::STATE_SAT)
+        throw std::logic_error(ILLEGAL_WORKER_MODEL);
+    return cxxsat::Solver::state_t::STATE_SAT;
+}
+
+cxxsat::Solver::state_t check_portfolio(uint32_t workers,
+                                        const std::vector<var_t>& assumptions,
+                                        const std::vector<var_t>& model_vars,
+                                        uint32_t timeout_ms)
+{
+    if (workers <= 1 && timeout_ms == 0) {
+        for (const var_t& v : assumptions) cxxsat::solver->assume(v);
+        return cxxsat::solver->check();
+    }
+
+    std::string answer;
+    const bool answered = run_forked(std::max(workers, uint32_t(1)), workers,
+        [&](uint32_t worker)
+        {
+            // The first worker keeps the order of the caller
+            std::vector<var_t> order(assumptions);
+            if (worker > 0) {
+                std::mt19937 rng(worker);
+                std::shuffle(order.begin(), order.end(), rng);
+            }
+            return solve_in_worker(order, model_vars);
+        },
+        [&](uint32_t, const std::string& data)
+        {
+            answer = data;
+            return true;
+        }, timeout_ms);
+    if (!answered) return cxxsat::Solver::state_t::STATE_INPUT;
+    return replay_answer(answer, assumptions, model_vars);
+}
+
+std::vector<std::vector<var_t>> make_region_cubes(const std::vector<var_t>& lits, uint32_t regions)
+{
+    std::vector<std::vector<var_t>> cubes;
+    std::vector<var_t> before;
+    regions = std::max(regions, uint32_t(1));
+    const size_t region_size = (lits.size() + regions - 1) / regions;
+    for (size_t beg = 0; beg < lits.size(); beg += region_size)
+    {
+        const size_t end = std::min(lits.size(), beg + region_size);
+        const std::vector<var_t> region(lits.begin() + beg, lits.begin() + end);
+        std::vector<var_t> cube(before);
+        cube.push_back(cxxsat::solver->make_or(region));
+        cubes.push_back(std::move(cube));
+        for (const var_t& lit : region) before.push_back(!lit);
+    }
+    cubes.push_back(std::move(before));
+    return cubes;
+}
+
+cxxsat::Solver::state_t check_cubes(const std::vector<std::vector<var_t>>& cubes,
+                                    const std::vector<var_t>& assumptions,
+                                    const std::vector<var_t>& model_vars,
+                                    uint32_t timeout_ms, std::ostream& out)
+{
+    const uint32_t workers = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string answer;
+    uint32_t refuted = 0;
+    const bool answered = run_forked(cubes.size(), workers,
+        [&](uint32_t cube_idx)
+        {
+            std::vector<var_t> cube_assumptions(assumptions);
+            cube_assumptions.insert(cube_assumptions.end(), cubes.at(cube_idx).begin(), cubes.at(cube_idx).end());
+            return solve_in_worker(cube_assumptions, model_vars);
+        },
+        [&](uint32_t, const std::string& data)
+        {
+            if (data == "U") {
+                refuted++;
+                return false;
+            }
+            answer = data;
+            return true;
+        }, timeout_ms);
+
+    out << refuted << "/" << cubes.size() << " cubes refuted: " << std::flush;
+    if (!answered) return cxxsat::Solver::state_t::STATE_INPUT;
+    if (answer.empty()) return cxxsat::Solver::state_t::STATE_UNSAT;
+    return replay_answer(answer, assumptions, model_vars);
+}
+
+cxxsat::Solver::state_t check_escalating(uint32_t workers, uint32_t timeout_ms,
+                                         const query_t& query,
+                                         const std::vector<var_t>& model_vars,
+                                         std::ostream& out)
+{
+    cxxsat::Solver::state_t res = check_portfolio(workers, query(false), model_vars, timeout_ms);
+    if (res != cxxsat::Solver::state_t::STATE_INPUT) return res;
+
+    out << "timeout, retry with sequential counters: " << std::flush;
+    res = check_portfolio(workers, query(true), model_vars, timeout_ms);
+    if (res != cxxsat::Solver::state_t::STATE_INPUT) return res;
+
+    const uint32_t escalation_workers = std::max(workers, uint32_t(ESCALATION_PORTFOLIO));
+    out << "timeout, retry with " << escalation_workers << " workers: " << std::flush;
+    res = check_portfolio(escalation_workers, query(false), model_vars, timeout_ms);
+    if (res != cxxsat::Solver::state_t::STATE_INPUT) return res;
+
+    out << "timeout, give up: " << std::flush;
+    return res;
+}
+
+// Answer of a speculative worker: 'U', or the answer of `solve_in_worker` for
+// its first counterexample followed by one line per proposal
+speculation_t speculate(uint32_t workers,
+                        const std::vector<var_t>& assumptions,
+                        const std::vector<var_t>& model_vars,
+                        const std::vector<var_t>& proposal_lits,
+                        uint32_t timeout_ms)
+{
+    // Each worker searches its own region of counterexamples, the last one
+    // those outside of every region
+    std::vector<std::vector<var_t>> cubes(1);
+    if (workers > 1) cubes = make_region_cubes(proposal_lits, workers - 1);
+
+    std::vector<std::string> answers(cubes.size());
+    const bool answered = run_forked(cubes.size(), cubes.size(),
+        [&](uint32_t worker)
+        {
+            std::vector<var_t> order(assumptions);
+            order.insert(order.end(), cubes.at(worker).begin(), cubes.at(worker).end());
+
+            std::string answer = solve_in_worker(order, model_vars);
+            for (uint32_t found = 0; found < SPECULATIVE_PROPOSALS; found++)
+            {
+                if (found > 0) {
+                    for (const var_t& v : order) cxxsat::solver->assume(v);
+                    if (cxxsat::solver->check() != cxxsat::Solver::state_t::STATE_SAT) break;
+                } else if (answer == "U") {
+                    break;
+                }
+
+                std::vector<var_t> blocking;
+                answer.push_back('\n');
+                for (const uint32_t idx : model_t(proposal_lits).true_indexes(0, proposal_lits.size()))
+                {
+                    answer += std::to_string(idx) + " ";
+                    blocking.push_back(!proposal_lits.at(idx));
+                }
+                cxxsat::solver->add_clause(cxxsat::solver->make_or(blocking));
+            }
+            return answer;
+        },
+        [&](uint32_t worker, const std::string& data)
+        {
+            answers.at(worker) = data;
+            return false;
+        }, timeout_ms);
+
+    speculation_t speculation;
+    speculation.state = cxxsat::Solver::state_t::STATE_UNSAT;
+    if (!answered) {
+        speculation.state = cxxsat::Solver::state_t::STATE_INPUT;
+        return speculation;
+    }
+
+    std::set<std::vector<uint32_t>> seen;
+    for (const std::string& answer : answers)
+    {
+        std::istringstream lines(answer);
+        std::string model;
+        std::getline(lines, model);
+        if (model == "U") continue;
+        if (speculation.proposals.empty())
+            speculation.state = replay_answer(model, assumptions, model_vars);
+
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            std::istringstream indices(line);
+            std::vector<uint32_t> proposal;
+            uint32_t idx;
+            while (indices >> idx) proposal.push_back(idx);
+            if (seen.insert(proposal).second) speculation.proposals.push_back(proposal);
+        }
+    }
+    return speculation;
+}
@@ -0,0 +1,131 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_PARALLEL_H
+#define VERIFIER_PARALLEL_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+#include "vars.h"
+
+using var_t = cxxsat::var_t;
+
+constexpr const char* ILLEGAL_FORK          = "Cannot fork a worker process";
+constexpr const char* ILLEGAL_WORKER_EXIT   = "Worker process did not complete its job";
+constexpr const char* ILLEGAL_WORKER_MODEL  = "Model returned by a worker does not satisfy the query";
+
+///////////   Forked workers   /////////////////////////////////////////////////
+// Workers are forked processes: they start from a copy of the whole state of
+// the parent, including the solver and its learned clauses, and send back a
+// string through a pipe. They leave with `_exit`, so that buffered outputs of
+// the parent are never flushed twice
+
+// Job run by a worker, from its index
+using worker_job_t = std::function<std::string(uint32_t)>;
+// Called in the parent on each result, returns whether to stop all workers
+using worker_result_t = std::function<bool(uint32_t, const std::string&)>;
+
+/*  Run jobs 0 to `num_jobs` - 1 in forked workers, at most `max_workers` at a
+ *  time. Results are handled in the parent in the order they arrive. When the
+ *  handler asks to stop, running workers are killed and the remaining jobs
+ *  never start. Returns false when `timeout_ms` expires first (none if 0)
+ */
+bool run_forked(uint32_t num_jobs, uint32_t max_workers,
+                const worker_job_t& job, const worker_result_t& on_result,
+                uint32_t timeout_ms = 0);
+
+/*  Check the global solver under `assumptions` with a portfolio of `workers`
+ *  forked solvers, each assuming them in its own random order, the first
+ *  answer winning. On SAT, the parent solver replays the model of the winner on
+ *  `model_vars`, which must determine the other variables of the query, so that
+ *  the model can be read from it afterwards. A single worker without timeout
+ *  checks in place. Returns STATE_INPUT, as a solver without answer, when
+ *  `timeout_ms` expires (none if 0)
+ */
+cxxsat::Solver::state_t check_portfolio(uint32_t workers,
+                                        const std::vector<var_t>& assumptions,
+                                        const std::vector<var_t>& model_vars,
+                                        uint32_t timeout_ms = 0);
+
+/*  Cubes covering the space of `lits`, which is cut in `regions` ranges: the
+ *  first true literal lies in a given range, or none is true. Their ORs are
+ *  defined in the global solver
+ */
+std::vector<std::vector<var_t>> make_region_cubes(const std::vector<var_t>& lits, uint32_t regions);
+
+/*  Check the global solver under `assumptions` with each of the `cubes`
+ *  assumed on top, in forked workers running on every core. A SAT cube
+ *  answers at once, its model being replayed as with `check_portfolio`, while
+ *  UNSAT requires all cubes to be refuted. Returns STATE_INPUT when
+ *  `timeout_ms` expires (none if 0). The refuted cubes are logged to `out`
+ */
+cxxsat::Solver::state_t check_cubes(const std::vector<std::vector<var_t>>& cubes,
+                                    const std::vector<var_t>& assumptions,
+                                    const std::vector<var_t>& model_vars,
+                                    uint32_t timeout_ms, std::ostream& out);
+
+// Minimal number of workers of the portfolio step of the escalation ladder
+#define ESCALATION_PORTFOLIO 4
+
+// Assumptions of a query, cardinality constraints using sequential counters
+// instead of the encoding of the solver when the flag is set
+using query_t = std::function<std::vector<var_t>(bool)>;
+
+/*  Check a query with `check_portfolio`, escalating each time `timeout_ms`
+ *  expires (none if 0):
+ *  - retry with sequential counters as cardinality constraints
+ *  - retry with a portfolio of at least `ESCALATION_PORTFOLIO` workers
+ *  - give up, returning STATE_INPUT
+ *  Every escalation is logged to `out`
+ */
+cxxsat::Solver::state_t check_escalating(uint32_t workers, uint32_t timeout_ms,
+                                         const query_t& query,
+                                         const std::vector<var_t>& model_vars,
+                                         std::ostream& out);
+
+// Counterexamples searched by each speculative worker
+#define SPECULATIVE_PROPOSALS 4
+
+///////////   Speculation_t   //////////////////////////////////////////////////
+// Counterexamples found by speculative workers from the same solver state, in
+// distinct region cubes
+
+struct speculation_t
+{
+    cxxsat::Solver::state_t state;
+    // Indices of the true `proposal_lits` of each counterexample, in the order
+    // of workers then of their search, without duplicates
+    std::vector<std::vector<uint32_t>> proposals;
+};
+
+/*  Search counterexamples of the global solver under `assumptions` with up to
+ *  `workers` forked solvers. The workers split the counterexamples into the
+ *  region cubes of `proposal_lits`, so that no two of them find the same one.
+ *  Each worker searches up to `SPECULATIVE_PROPOSALS` counterexamples in its
+ *  cube, blocking the true `proposal_lits` of the ones it already found. All
+ *  workers are waited for, so that proposals do not depend on timing. The
+ *  model of the first proposal is replayed in the parent as with
+ *  `check_portfolio`. Returns STATE_INPUT when `timeout_ms` expires (none if 0)
+ */
+speculation_t speculate(uint32_t workers,
+                        const std::vector<var_t>& assumptions,
+                        const std::vector<var_t>& model_vars,
+                        const std::vector<var_t>& proposal_lits,
+                        uint32_t timeout_ms = 0);
+
+#endif // VERIFIER_PARALLEL_H
@@ -0,0 +1,100 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+#include "result_cache.h"
+#include "cnf.h"
+#include "utils.h"
+
+ResultCache::ResultCache(const std::string& dir) : m_dir(dir)
+{
+    if (enabled()) std::filesystem::create_directories(m_dir);
+}
+
+std::string ResultCache::file_name(const std::string& key) const
+{
+    std::stringstream ss;
+    ss << m_dir << "/" << std::hex << fnv1a(key) << ".result";
+    return ss.str();
+}
+
+bool ResultCache::lookup(const std::string& key, const std::vector<var_t>& assumptions,
+                         const std::vector<var_t>& model_vars, cxxsat::Solver::state_t& res)
+{
+    if (!enabled()) return false;
+    m_lookups++;
+
+    // The first line holds the whole key, against collisions of its hash
+    std::ifstream f(file_name(key));
+    std::string stored_key, answer;
+    if (!std::getline(f, stored_key) || stored_key != key || !std::getline(f, answer))
+        return false;
+
+    if (answer == "U") {
+        res = cxxsat::Solver::state_t::STATE_UNSAT;
+    } else {
+        if (answer.size() != 1 + model_vars.size() || answer.front() != 'S') return false;
+        for (const var_t& v : assumptions) cxxsat::solver->assume(v);
+        for (size_t idx = 0; idx < model_vars.size(); idx++)
+            cxxsat::solver->assume(answer.at(idx + 1) == '1' ? model_vars.at(idx) : !model_vars.at(idx));
+        if (cxxsat::solver->check() != cxxsat::Solver::state_t::STATE_SAT) return false;
+        res = cxxsat::Solver::state_t::STATE_SAT;
+    }
+    m_hits++;
+    return true;
+}
+
+void ResultCache::store(const std::string& key, cxxsat::Solver::state_t res,
+                        const std::vector<var_t>& model_vars) const
+{
+    if (!enabled() || res == cxxsat::Solver::state_t::STATE_INPUT) return;
+
+    std::string answer("U");
+    if (res == cxxsat::Solver::state_t::STATE_SAT) {
+        answer = "S";
+        const model_t values(model_vars);
+        for (size_t idx = 0; idx < values.size(); idx++)
+            answer.push_back(values[idx] ? '1' : '0');
+    }
+
+    // Written aside and renamed, as concurrent runs may share the directory
+    const std::string name = file_name(key);
+    const std::string tmp_name = name + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream f(tmp_name);
+    f << key << std::endl << answer << std::endl;
+    f.close();
+    std::filesystem::rename(tmp_name, name);
+}
+
+uint64_t signals_hash(const std::unordered_set<signal_id_t>& sigs)
+{
+    std::vector<signal_id_t> sorted(sigs.begin(), sigs.end());
+    std::sort(sorted.begin(), sorted.end());
+    return fnv1a(std::string(reinterpret_cast<const char*>(sorted.data()), sorted.size() * sizeof(signal_id_t)));
+}
+
+uint64_t partitions_hash(const std::vector<std::unordered_set<signal_id_t>>& partitions)
+{
+    std::vector<uint64_t> hashes;
+    for (const auto& partition : partitions)
+        hashes.push_back(signals_hash(partition));
+    std::sort(hashes.begin(), hashes.end());
+    return fnv1a(std::string(reinterpret_cast<const char*>(hashes.data()), hashes.size() * sizeof(uint64_t)));
+}
@@ -0,0 +1,71 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_RESULT_CACHE_H
+#define VERIFIER_RESULT_CACHE_H
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "Solver.h"
+#include "vars.h"
+#include "Circuit.h"
+
+using var_t = cxxsat::var_t;
+
+///////////   ResultCache   ////////////////////////////////////////////////////
+// Answers of SAT queries kept across runs in a directory, one file per query
+// named after the hash of its key. The key describes the query by its
+// meaning, so that runs encoding it differently share answers. A SAT answer
+// holds the values of the free variables of the unrolling, which determine
+// the counterexample and are replayed in the solver, so that the model can be
+// read as if the query had been solved
+
+class ResultCache
+{
+private:
+    std::string m_dir;
+    uint32_t m_hits = 0;
+    uint32_t m_lookups = 0;
+
+    std::string file_name(const std::string& key) const;
+
+public:
+    // Disabled if `dir` is empty
+    explicit ResultCache(const std::string& dir);
+
+    bool enabled() const { return !m_dir.empty(); }
+    uint32_t hits() const { return m_hits; }
+    uint32_t lookups() const { return m_lookups; }
+
+    /*  Answer of the query `key` on the global solver under `assumptions`.
+     *  Returns false when the answer is not cached, or when its model does not
+     *  satisfy the query, which is then left to the solver
+     */
+    bool lookup(const std::string& key, const std::vector<var_t>& assumptions,
+                const std::vector<var_t>& model_vars, cxxsat::Solver::state_t& res);
+
+    // Record the answer just found by the global solver, unless unknown
+    void store(const std::string& key, cxxsat::Solver::state_t res,
+               const std::vector<var_t>& model_vars) const;
+};
+
+// Hash of the partitions as sets of signals, whatever their order
+uint64_t partitions_hash(const std::vector<std::unordered_set<signal_id_t>>& partitions);
+
+// Hash of a set of signals
+uint64_t signals_hash(const std::unordered_set<signal_id_t>& sigs);
+
+#endif // VERIFIER_RESULT_CACHE_H
@@ -0,0 +1,139 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <map>
+#include <random>
+
+#include "sweeping.h"
+#include "Simulator.h"
+#include "utils.h"
+#include "cnf.h"
+#include "backend.h"
+
+using sim_state_t = std::unordered_map<signal_id_t, sim_word_t>;
+
+// Signatures of all signals over `SWEEP_SIM_WORDS` random states
+static std::unordered_map<signal_id_t, std::vector<uint64_t>> simulate_signatures(
+    const Circuit& circuit, const std::vector<signal_id_t>& free_sigs)
+{
+    std::unordered_map<signal_id_t, std::vector<uint64_t>> signatures;
+    std::mt19937_64 rng(42);
+    const sim_state_t empty;
+    for (uint32_t word = 0; word < SWEEP_SIM_WORDS; word++)
+    {
+        sim_state_t state;
+        state.emplace(signal_id_t::S_0, sim_from_bool(false));
+        state.emplace(signal_id_t::S_1, sim_from_bool(true));
+        state.emplace(signal_id_t::S_X, sim_from_bool(false));
+        state.emplace(signal_id_t::S_Z, sim_from_bool(false));
+        for (signal_id_t sig : free_sigs) state.emplace(sig, sim_word_t(rng()));
+
+        for (const Cell* cell : circuit.cells())
+        {
+            if (!is_register(cell->type()))
+                cell->eval<sim_word_t, sim_word_t, sim_from_bool>(empty, state);
+        }
+        for (const auto& [sig, value] : state)
+            signatures[sig].push_back(value.bits);
+    }
+    return signatures;
+}
+
+sweeping_t compute_sweeping(const Circuit& circuit, const std::string& sat_backend)
+{
+    sweeping_t sweeping;
+
+    std::vector<signal_id_t> free_sigs(circuit.ins().begin(), circuit.ins().end());
+    free_sigs.insert(free_sigs.end(), circuit.regs().begin(), circuit.regs().end());
+    std::sort(free_sigs.begin(), free_sigs.end());
+    const auto signatures = simulate_signatures(circuit, free_sigs);
+
+    // Gates are encoded in a CNF of their own, loaded into the backend before
+    // each check
+    std::unique_ptr<SatBackend> backend = make_backend(sat_backend);
+    cnf_sync_t sync;
+    Cnf cnf;
+    Cnf* const analysis_cnf = cnf_builder;
+    cnf_builder = &cnf;
+
+    std::unordered_map<signal_id_t, lit_t> state;
+    init_constants(state);
+    for (signal_id_t sig : free_sigs) state.emplace(sig, cnf.new_var());
+
+    // Signatures are complemented to start with 0, so that complementary
+    // signals fall in the same class. Each class keeps its representatives,
+    // the constant 0 and free signals coming first
+    std::map<std::vector<uint64_t>, std::vector<signal_id_t>> classes;
+    const auto class_of = [&signatures, &classes](signal_id_t sig, bool& flip) -> std::vector<signal_id_t>&
+    {
+        std::vector<uint64_t> key(signatures.at(sig));
+        flip = key.front() & 1;
+        if (flip) for (uint64_t& word : key) word = ~word;
+        return classes[std::move(key)];
+    };
+
+    bool flip;
+    class_of(signal_id_t::S_0, flip).push_back(signal_id_t::S_0);
+    for (signal_id_t sig : free_sigs) class_of(sig, flip).push_back(sig);
+
+    const std::unordered_map<signal_id_t, lit_t> empty;
+    for (const Cell* cell : circuit.cells())
+    {
+        if (is_register(cell->type())) continue;
+        cell->eval<lit_t, lit_t&, make_const<lit_t>>(empty, state);
+
+        const signal_id_t out_y = cell->ports().m_unr.m_out_y;
+        std::vector<signal_id_t>& reps = class_of(out_y, flip);
+        if (!reps.empty()) sweeping.candidates++;
+
+        uint32_t tries = 0;
+        for (const signal_id_t rep : reps)
+        {
+            if (tries++ == SWEEP_MAX_REPS) break;
+            const bool complement = flip != (signatures.at(rep).front() & 1);
+            const lit_t rep_var = complement ? !state.at(rep) : state.at(rep);
+
+            if (!(state.at(out_y) == rep_var)) {
+                sweeping.checked++;
+                const lit_t diff = state.at(out_y) ^ rep_var;
+                sync_cnf(cnf, *backend, sync);
+                backend->assume(to_backend(sync, diff));
+                if (backend->check() == cxxsat::Solver::state_t::STATE_SAT) {
+                    sweeping.disproved++;
+                    continue;
+                }
+            }
+
+            // Later gates read the representative
+            state.at(out_y) = rep_var;
+            sweeping.repr.emplace(out_y, std::make_pair(rep, complement));
+            break;
+        }
+        if (sweeping.repr.find(out_y) == sweeping.repr.end()) reps.push_back(out_y);
+    }
+
+    cnf_builder = analysis_cnf;
+    return sweeping;
+}
+
+std::stringstream sweeping_info(const sweeping_t& sweeping)
+{
+    std::stringstream ss;
+    ss << "******* SAT sweeping ********" << std::endl;
+    ss << "Candidate gates: " << sweeping.candidates << std::endl;
+    ss << "SAT checks: " << sweeping.checked << " (" << sweeping.disproved << " disproved)" << std::endl;
+    ss << "Merged gates: " << sweeping.repr.size() << std::endl;
+    return ss;
+}
@@ -0,0 +1,55 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_SWEEPING_H
+#define VERIFIER_SWEEPING_H
+
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "Circuit.h"
+
+// Number of 64-bit words of random patterns assigning signatures
+#define SWEEP_SIM_WORDS 16
+// Representatives of a class checked against a signal before it becomes one
+#define SWEEP_MAX_REPS 4
+
+///////////   Sweeping_t   /////////////////////////////////////////////////////
+// Gates of the golden circuit equivalent to a constant, an input, a register
+// or an earlier gate, for all values of the inputs and registers
+
+struct sweeping_t
+{
+    // Representative of each swept gate, and whether it is complemented
+    std::unordered_map<signal_id_t, std::pair<signal_id_t, bool>> repr;
+    uint32_t candidates = 0;
+    uint32_t checked = 0;
+    uint32_t disproved = 0;
+};
+
+/*  Sweep the combinational logic of the circuit, inputs and registers being
+ *  free:
+ *  - gates with the same random simulation signature, up to complement, are
+ *    candidate equivalents
+ *  - each candidate is checked against the representatives of its class with
+ *    incremental SAT, on an encoding where proven gates are already merged,
+ *    with the backend of `sat_backend` (see `make_backend`)
+ */
+sweeping_t compute_sweeping(const Circuit& circuit, const std::string& sat_backend);
+
+std::stringstream sweeping_info(const sweeping_t& sweeping);
+
+#endif // VERIFIER_SWEEPING_H
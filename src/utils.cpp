@@ -12,7 +12,10 @@
  *
  */
 
+#include <algorithm>
+
 #include "utils.h"
+#include "Simulator.h"
 
 using json = nlohmann::json;
 
@@ -27,6 +30,42 @@ std::string replace_all(const std::string& s, const std::string& x, const std::s
     return input; 
 }
 
+model_t::model_t(const std::vector<var_t>& lits) : model_t(lits.size())
+{
+    for (size_t idx = 0; idx < lits.size(); idx++)
+    {
+        if (cxxsat::solver->value(lits[idx])) set(idx);
+    }
+}
+
+std::vector<uint32_t> model_t::true_indexes(size_t beg, size_t end) const
+{
+    std::vector<uint32_t> indexes;
+    for (size_t word = beg >> 6; word < m_bits.size() && (word << 6) < end; word++)
+    {
+        uint64_t bits = m_bits[word];
+        while (bits)
+        {
+            const size_t idx = (word << 6) + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (idx >= beg && idx < end) indexes.push_back(idx - beg);
+        }
+    }
+    return indexes;
+}
+
+model_t read_state(const std::unordered_map<signal_id_t, var_t>& state,
+                   const std::vector<signal_id_t>& sigs)
+{
+    model_t values(sigs.size());
+    for (size_t idx = 0; idx < sigs.size(); idx++)
+    {
+        const auto& it = state.find(sigs[idx]);
+        if (it != state.end() && cxxsat::solver->value(it->second)) values.set(idx);
+    }
+    return values;
+}
+
 void dump_vcd(const std::string& file_name, const Circuit& circ,
               const std::vector<std::unordered_map<signal_id_t, var_t>>& trace_g,
               const std::vector<std::unordered_map<signal_id_t, var_t>>& trace_f,
@@ -112,6 +151,17 @@ void dump_vcd(const std::string& file_name, const Circuit& circ,
         return;
     }
 
+    // The model is read once per cycle and signal of each trace
+    std::vector<signal_id_t> vcd_sigs;
+    for (const auto& it: signals_in_vcd) vcd_sigs.push_back(it.first);
+    std::vector<model_t> values_g;
+    std::vector<model_t> values_f;
+    for (uint32_t cycle = 0; cycle < trace_g.size(); cycle++)
+    {
+        values_g.push_back(read_state(trace_g.at(cycle), vcd_sigs));
+        values_f.push_back(read_state(trace_f.at(cycle), vcd_sigs));
+    }
+
     // Dump the first cycle
     auto prev_ptr_g = trace_g.cbegin();
     auto curr_ptr_g = trace_g.cbegin();
@@ -128,7 +178,6 @@ void dump_vcd(const std::string& file_name, const Circuit& circ,
         const std::unordered_map<signal_id_t, var_t>& curr_map_g = *curr_ptr_g;
         const std::unordered_map<signal_id_t, var_t>& prev_map_g = *prev_ptr_g;
 
-        const std::unordered_map<signal_id_t, var_t>& curr_map_f = *curr_ptr_f;
         const std::unordered_map<signal_id_t, var_t>& prev_map_f = *prev_ptr_f;
 
         if (circ.clock() != signal_id_t::S_0)
@@ -138,15 +187,22 @@ void dump_vcd(const std::string& file_name, const Circuit& circ,
             out << "b1 d" << vcd_identifier(circ.clock()) << std::endl;
         }
 
+        const uint32_t cycle = curr_tick / 1000;
+        const model_t& curr_values_g = values_g.at(cycle);
+        const model_t& curr_values_f = values_f.at(cycle);
+        const model_t& prev_values_g = values_g.at(cycle ? cycle - 1 : 0);
+        const model_t& prev_values_f = values_f.at(cycle ? cycle - 1 : 0);
+
+        uint32_t sig_idx = 0;
         for (const auto& it: signals_in_vcd)
         {
+            const uint32_t idx = sig_idx++;
             auto curr_find_it_g = curr_map_g.find(it.first);
             auto prev_find_it_g = prev_map_g.find(it.first);
-            auto curr_find_it_f = curr_map_f.find(it.first);
             auto prev_find_it_f = prev_map_f.find(it.first);
 
             assert((curr_find_it_g != curr_map_g.end()) ==
-                   (curr_find_it_f != curr_map_f.end()));
+                   (curr_ptr_f->find(it.first) != curr_ptr_f->end()));
             assert((prev_find_it_g != prev_map_g.end()) ==
                    (prev_find_it_f != prev_map_f.end()));
 
@@ -155,8 +211,8 @@ void dump_vcd(const std::string& file_name, const Circuit& circ,
             {
                 if (curr_find_it_g != curr_map_g.end())
                 {
-                    bool val_g = cxxsat::solver->value(curr_find_it_g->second);
-                    bool val_f = cxxsat::solver->value(curr_find_it_f->second);
+                    bool val_g = curr_values_g[idx];
+                    bool val_f = curr_values_f[idx];
 
                     out << "b" << val_g << " g" << vcd_id << std::endl;
                     out << "b" << val_f << " f" << vcd_id << std::endl;
@@ -171,14 +227,14 @@ void dump_vcd(const std::string& file_name, const Circuit& circ,
             }
             else if (curr_find_it_g != curr_map_g.end())
             {
-                bool curr_val_g = cxxsat::solver->value(curr_find_it_g->second);
-                bool curr_val_f = cxxsat::solver->value(curr_find_it_f->second);
+                bool curr_val_g = curr_values_g[idx];
+                bool curr_val_f = curr_values_f[idx];
 
                 if (prev_find_it_g == prev_map_g.end() ||
-                    curr_val_g != cxxsat::solver->value(prev_find_it_g->second))
+                    curr_val_g != prev_values_g[idx])
                 { out << "b" << curr_val_g << " g" << vcd_id << std::endl; }
                 if (prev_find_it_f == prev_map_f.end() ||
-                    curr_val_f != cxxsat::solver->value(prev_find_it_f->second))
+                    curr_val_f != prev_values_f[idx])
                 { out << "b" << curr_val_f << " f" << vcd_id << std::endl; }
 
                 if (prev_find_it_g == prev_map_g.end() && prev_find_it_f == prev_map_f.end())
@@ -188,8 +244,8 @@ void dump_vcd(const std::string& file_name, const Circuit& circ,
                 }
                 else
                 {
-                    bool prev_val_g = cxxsat::solver->value(prev_find_it_g->second);
-                    bool prev_val_f = cxxsat::solver->value(prev_find_it_f->second);
+                    bool prev_val_g = prev_values_g[idx];
+                    bool prev_val_f = prev_values_f[idx];
 
                     if ((curr_val_g != prev_val_g) || (curr_val_f != prev_val_f))
                     {
@@ -309,20 +365,231 @@ std::stringstream partition_info(const Circuit& circuit,
     return ss;
 }
 
-void init_constants(std::unordered_map<signal_id_t, var_t>& state)
+template <typename V>
+void init_constants(std::unordered_map<signal_id_t, V>& state)
+{
+    state.emplace(signal_id_t::S_0, V::ZERO);
+    state.emplace(signal_id_t::S_1, V::ONE);
+    state.emplace(signal_id_t::S_X, V::ZERO);
+    state.emplace(signal_id_t::S_Z, V::ZERO);
+}
+
+var_t make_guarded_or(const std::vector<var_t>& ops, const var_t& act)
+{
+    if (ops.empty()) return var_t::ZERO;
+
+    // Tree of OR nodes, each clause being guarded by `act`
+    std::vector<var_t> level(ops);
+    do
+    {
+        std::vector<var_t> next;
+        for (size_t beg = 0; beg < level.size(); beg += GUARDED_OR_FANIN)
+        {
+            const size_t end = std::min(level.size(), beg + GUARDED_OR_FANIN);
+            var_t y = cxxsat::solver->new_var();
+            std::vector<var_t> y_implies_ops = {!act, !y};
+            for (size_t idx = beg; idx < end; idx++)
+            {
+                cxxsat::solver->add_clause(!act, y, !level.at(idx));
+                y_implies_ops.push_back(level.at(idx));
+            }
+            add_clause_lits(y_implies_ops);
+            next.push_back(y);
+        }
+        level = std::move(next);
+    } while (level.size() > 1);
+
+    return level.front();
+}
+
+var_t make_seq_at_most(const std::vector<var_t>& ops, uint32_t k)
 {
-    state.emplace(signal_id_t::S_0, var_t::ZERO);
-    state.emplace(signal_id_t::S_1, var_t::ONE);
-    state.emplace(signal_id_t::S_X, var_t::ZERO);
-    state.emplace(signal_id_t::S_Z, var_t::ZERO);
+    if (ops.size() <= k) return var_t::ONE;
+
+    // `count.at(j)` is implied when more than `j` processed operands are true
+    const var_t act = cxxsat::solver->new_var();
+    std::vector<var_t> count;
+    for (const var_t& op : ops)
+    {
+        if (k == 0) {
+            cxxsat::solver->add_clause(!act, !op);
+            continue;
+        }
+        if (count.size() == k) cxxsat::solver->add_clause(!act, !op, !count.at(k - 1));
+        std::vector<var_t> next;
+        for (uint32_t j = 0; j < k; j++)
+        {
+            const var_t s = cxxsat::solver->new_var();
+            if (j == 0) cxxsat::solver->add_clause(!op, s);
+            else if (j <= count.size()) cxxsat::solver->add_clause(!op, !count.at(j - 1), s);
+            if (j < count.size()) cxxsat::solver->add_clause(!count.at(j), s);
+            next.push_back(s);
+        }
+        count = std::move(next);
+    }
+    return act;
+}
+
+static bool is_collapsed(const encoding_t& encoding, signal_id_t sig)
+{
+    return encoding.xor_chains != nullptr &&
+           encoding.xor_chains->inner.find(sig) != encoding.xor_chains->inner.end();
+}
+
+/*  Difference between the faulty and golden values of `sig`. Deltas are kept
+ *  along with the faulty value they were defined for, so that faults induced
+ *  on a signal after its evaluation define a new one
+ */
+template <typename V>
+static V delta_of(signal_id_t sig, const std::unordered_map<signal_id_t, V>& golden_state,
+                  const std::unordered_map<signal_id_t, V>& faulty_state,
+                  std::unordered_map<signal_id_t, std::pair<V, V>>& deltas)
+{
+    const V& golden = golden_state.at(sig);
+    const V& faulty = faulty_state.at(sig);
+    if (faulty == golden) return V::ZERO;
+    const auto& f = deltas.find(sig);
+    if (f != deltas.end() && f->second.first == faulty) return f->second.second;
+    const V delta = faulty ^ golden;
+    deltas[sig] = std::make_pair(faulty, delta);
+    return delta;
 }
 
+/*  Faulty value of a gate as its golden value XOR a delta propagated from the
+ *  deltas of its inputs:
+ *  - a gate without input delta has no delta
+ *  - a delta crosses a NOT/BUF, and XOR gates add the deltas of their inputs
+ *  - a delta crosses an AND (resp. OR) when the golden value of the other
+ *    input is 1 (resp. 0), and a MUX input when it is selected
+ *  Multiplexers with a delta on their select are evaluated on the faulty
+ *  inputs
+ */
+template <typename V>
+static void eval_faulty_delta(const Cell* cell, const std::unordered_map<signal_id_t, V>& prev_faulty_state,
+                              const std::unordered_map<signal_id_t, V>& golden_state,
+                              std::unordered_map<signal_id_t, V>& faulty_state,
+                              std::unordered_map<signal_id_t, std::pair<V, V>>& deltas)
+{
+    const Ports& ports = cell->ports();
+    const signal_id_t out_y = ports.m_unr.m_out_y;
+    const auto delta = [&](signal_id_t sig) { return delta_of(sig, golden_state, faulty_state, deltas); };
+    const V zero = V::ZERO;
+    V d_y = zero;
+
+    if (is_unary(cell->type())) {
+        d_y = delta(ports.m_unr.m_in_a);
+    } else if (is_binary(cell->type())) {
+        const V& a = golden_state.at(ports.m_bin.m_in_a);
+        const V b = is_second_negated(cell->type()) ? !golden_state.at(ports.m_bin.m_in_b)
+                                                    : golden_state.at(ports.m_bin.m_in_b);
+        const V d_a = delta(ports.m_bin.m_in_a);
+        const V d_b = delta(ports.m_bin.m_in_b);
+        if (gate_is_like_xor(cell->type())) {
+            d_y = (d_a == zero) ? d_b : (d_b == zero) ? d_a : d_a ^ d_b;
+        } else {
+            // An OR is an AND of negated inputs, with the same deltas
+            const bool like_and = gate_is_like_and(cell->type());
+            assert(like_and || gate_is_like_or(cell->type()));
+            const V cond_a = like_and ? b : !b;
+            const V cond_b = like_and ? a : !a;
+            if (d_b == zero) d_y = d_a & cond_a;
+            else if (d_a == zero) d_y = d_b & cond_b;
+            else d_y = (d_a & cond_a) ^ (d_b & cond_b) ^ (d_a & d_b);
+        }
+    } else {
+        assert(is_multiplexer(cell->type()));
+        const V d_s = delta(ports.m_mux.m_in_s);
+        if (!(d_s == zero)) {
+            cell->eval<V, V&, make_const<V>>(prev_faulty_state, faulty_state);
+            delta(out_y);
+            return;
+        }
+        const V& s = golden_state.at(ports.m_mux.m_in_s);
+        const V d_a = delta(ports.m_mux.m_in_a);
+        const V d_b = delta(ports.m_mux.m_in_b);
+        if (d_a == zero) d_y = (d_b == zero) ? zero : s & d_b;
+        else d_y = (d_b == zero) ? (!s) & d_a : mux(s, d_b, d_a);
+    }
+
+    if (d_y == zero) {
+        faulty_state.emplace(out_y, golden_state.at(out_y));
+        return;
+    }
+    const V faulty = golden_state.at(out_y) ^ d_y;
+    faulty_state.emplace(out_y, faulty);
+    deltas[out_y] = std::make_pair(faulty, d_y);
+}
+
+/*  Evaluate a cell in the golden and faulty states with the selected encodings.
+ *  Returns false when its output is not materialized, i.e. collapsed in an XOR
+ *  chain or absorbed in a LUT
+ */
+template <typename V>
+static bool eval_cell(const Cell* cell, const encoding_t& encoding,
+                      const std::unordered_map<signal_id_t, V>& prev_golden_state,
+                      std::unordered_map<signal_id_t, V>& golden_state,
+                      const std::unordered_map<signal_id_t, V>& prev_faulty_state,
+                      std::unordered_map<signal_id_t, V>& faulty_state,
+                      const std::unordered_map<signal_id_t, fault_spec<V>>& current_faults,
+                      std::unordered_map<signal_id_t, std::pair<V, V>>& deltas)
+{
+    if (!is_register(cell->type()))
+    {
+        const signal_id_t& out_y = cell->ports().m_unr.m_out_y;
+        if (encoding.xor_chains != nullptr) {
+            if (is_collapsed(encoding, out_y)) return false;
+            const auto& f = encoding.xor_chains->roots.find(out_y);
+            if (f != encoding.xor_chains->roots.end()) {
+                eval_xor_chain(f->second, prev_golden_state, golden_state,
+                               prev_faulty_state, faulty_state, current_faults);
+                return true;
+            }
+        }
+        if (encoding.cut_cover != nullptr) {
+            const cut_cover_t& cut_cover = *encoding.cut_cover;
+            if (cut_cover.absorbed.find(out_y) != cut_cover.absorbed.end()) return false;
+            const auto& f = cut_cover.luts.find(out_y);
+            if (f != cut_cover.luts.end()) {
+                eval_lut(out_y, f->second, prev_golden_state, golden_state, faulty_state);
+                return true;
+            }
+        }
+        if (encoding.sweeping != nullptr) {
+            const auto& f = encoding.sweeping->repr.find(out_y);
+            if (f != encoding.sweeping->repr.end() && golden_state.find(f->second.first) != golden_state.end()) {
+                const V& rep = golden_state.at(f->second.first);
+                golden_state.emplace(out_y, f->second.second ? !rep : rep);
+                // The faulty gate only differs if one of its inputs does
+                const std::vector<signal_id_t> ins = cell_inputs(cell);
+                if (std::all_of(ins.begin(), ins.end(), [&](signal_id_t in)
+                        { return faulty_state.at(in) == golden_state.at(in); }))
+                    faulty_state.emplace(out_y, golden_state.at(out_y));
+                else if (encoding.delta)
+                    eval_faulty_delta(cell, prev_faulty_state, golden_state, faulty_state, deltas);
+                else
+                    cell->eval<V, V&, make_const<V>>(prev_faulty_state, faulty_state);
+                return true;
+            }
+        }
+        if (encoding.delta) {
+            cell->eval<V, V&, make_const<V>>(prev_golden_state, golden_state);
+            eval_faulty_delta(cell, prev_faulty_state, golden_state, faulty_state, deltas);
+            return true;
+        }
+    }
+    cell->eval<V, V&, make_const<V>>(prev_golden_state, golden_state);
+    cell->eval<V, V&, make_const<V>>(prev_faulty_state, faulty_state);
+    return true;
+}
+
+template <typename V>
 void unroll_with_faults(const Circuit& circuit,
-                        std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
-                        std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                        std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                        std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
                         const std::unordered_set<signal_id_t>& f_sigs,
-                        std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults,
-                        const std::unordered_set<signal_id_t>& alert_signals)
+                        std::vector<std::unordered_map<signal_id_t, fault_spec<V>>>& faults,
+                        const std::unordered_set<signal_id_t>& alert_signals,
+                        const encoding_t& encoding)
 {
     assert(golden_trace.size() == faulty_trace.size());
     assert(golden_trace.size() == faults.size());
@@ -332,23 +599,23 @@ void unroll_with_faults(const Circuit& circuit,
     faulty_trace.emplace_back();
     faults.emplace_back();
     
-    std::unordered_map<signal_id_t, var_t>& golden_state = golden_trace.back();
-    std::unordered_map<signal_id_t, var_t>& faulty_state = faulty_trace.back();
-    std::unordered_map<signal_id_t, fault_spec_t>& current_faults = faults.back();
+    std::unordered_map<signal_id_t, V>& golden_state = golden_trace.back();
+    std::unordered_map<signal_id_t, V>& faulty_state = faulty_trace.back();
+    std::unordered_map<signal_id_t, fault_spec<V>>& current_faults = faults.back();
     
     init_constants(golden_state);
     init_constants(faulty_state);
 
     // Declare golden symbols for inputs
     for (signal_id_t sig : circuit.ins()) {
-        golden_state.emplace(sig, cxxsat::solver->new_var());
+        golden_state.emplace(sig, new_var<V>());
     }
 
     // Create symbols as faulty copies for inputs belonging to f_sigs
     for (signal_id_t sig: circuit.ins())
     {
         if (f_sigs.find(sig) != f_sigs.end()) {
-            fault_spec_t f;
+            fault_spec<V> f;
             current_faults.emplace(sig, f);
             faulty_state.emplace(sig, f.induce_fault(golden_state.at(sig)));
         } else {
@@ -356,13 +623,14 @@ void unroll_with_faults(const Circuit& circuit,
         }
     }
 
-    const std::unordered_map<signal_id_t, var_t>& prev_golden_state = golden_trace.at(num_steps - 1);
-    const std::unordered_map<signal_id_t, var_t>& prev_faulty_state = faulty_trace.at(num_steps - 1);
+    const std::unordered_map<signal_id_t, V>& prev_golden_state = golden_trace.at(num_steps - 1);
+    const std::unordered_map<signal_id_t, V>& prev_faulty_state = faulty_trace.at(num_steps - 1);
 
+    std::unordered_map<signal_id_t, std::pair<V, V>> deltas;
     for (const Cell* cell : circuit.cells())
     {
-        cell->eval<var_t, var_t&, cxxsat::from_bool>(prev_golden_state, golden_state);
-        cell->eval<var_t, var_t&, cxxsat::from_bool>(prev_faulty_state, faulty_state);
+        const bool materialized = eval_cell(cell, encoding, prev_golden_state, golden_state,
+                                            prev_faulty_state, faulty_state, current_faults, deltas);
 
         if (is_register(cell->type())) continue;
 
@@ -378,20 +646,25 @@ void unroll_with_faults(const Circuit& circuit,
         const std::unordered_set<signal_id_t>& conn_outs = *circuit.get_conn_outs(cell_out);
         for (const signal_id_t& out : conn_outs) {
             if (alert_signals.find(out) != alert_signals.end()) {
-                fault_spec_t f;
+                fault_spec<V> f;
                 current_faults.emplace(cell_out, f);
-                faulty_state.at(cell_out) = f.induce_fault(faulty_state.at(cell_out));
+                // Bit-flips of collapsed gates are added to the parity of their root
+                assert(materialized || is_collapsed(encoding, cell_out));
+                if (materialized)
+                    faulty_state.at(cell_out) = f.induce_fault(faulty_state.at(cell_out));
                 break;
             }
         }
     }
 }
 
+template <typename V>
 void unroll_init_with_faults(const Circuit& circuit,
-                             std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
-                             std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                             std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                             std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
                              const std::unordered_set<signal_id_t>& f_sigs,
-                             std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults)
+                             std::vector<std::unordered_map<signal_id_t, fault_spec<V>>>& faults,
+                             const encoding_t& encoding)
 {
     assert(golden_trace.empty());
     assert(faulty_trace.empty());
@@ -401,22 +674,22 @@ void unroll_init_with_faults(const Circuit& circuit,
     golden_trace.emplace_back();
     faults.emplace_back();
 
-    std::unordered_map<signal_id_t, var_t>& golden_state = golden_trace.back();
-    std::unordered_map<signal_id_t, var_t>& faulty_state = faulty_trace.back();
-    std::unordered_map<signal_id_t, fault_spec_t>& current_faults = faults.back();
+    std::unordered_map<signal_id_t, V>& golden_state = golden_trace.back();
+    std::unordered_map<signal_id_t, V>& faulty_state = faulty_trace.back();
+    std::unordered_map<signal_id_t, fault_spec<V>>& current_faults = faults.back();
 
     init_constants(golden_state);
     init_constants(faulty_state);
 
     // Declare golden symbols for inputs
     for (signal_id_t sig : circuit.ins())
-    { golden_state.emplace(sig, cxxsat::solver->new_var()); }
+    { golden_state.emplace(sig, new_var<V>()); }
 
     // Create symbols as faulty copies for inputs belonging to f_sigs
     for (const signal_id_t sig: circuit.ins())
     {
         if (f_sigs.find(sig) != f_sigs.end()) {
-            fault_spec_t f;
+            fault_spec<V> f;
             current_faults.emplace(sig, f);
             faulty_state.emplace(sig, f.induce_fault(golden_state.at(sig)));
         } else {
@@ -427,35 +700,139 @@ void unroll_init_with_faults(const Circuit& circuit,
     // Duplicate regs
     for (const signal_id_t sig : circuit.regs())
     {
-        golden_state.emplace(sig, cxxsat::solver->new_var());
-        faulty_state.emplace(sig, cxxsat::solver->new_var());
+        golden_state.emplace(sig, new_var<V>());
+        faulty_state.emplace(sig, new_var<V>());
     }
 
     // Forward the symbols through the wires
-    std::unordered_map<signal_id_t, var_t> empty;
+    std::unordered_map<signal_id_t, V> empty;
+    std::unordered_map<signal_id_t, std::pair<V, V>> deltas;
 
     for (const Cell* cell : circuit.cells())
     {
         if (is_register(cell->type())) continue;
 
-        cell->eval<var_t, var_t&, cxxsat::from_bool>(empty, golden_state);
-        cell->eval<var_t, var_t&, cxxsat::from_bool>(empty, faulty_state);
-
         const Ports& ports = cell->ports();
         assert(&(ports.m_unr.m_out_y) == &(ports.m_bin.m_out_y));
         assert(&(ports.m_unr.m_out_y) == &(ports.m_mux.m_out_y));
         const signal_id_t& out_sig = ports.m_bin.m_out_y;
 
+        const bool materialized = eval_cell(cell, encoding, empty, golden_state,
+                                            empty, faulty_state, current_faults, deltas);
+
         if (f_sigs.find(out_sig) != f_sigs.end()) {
-            fault_spec_t f;
+            fault_spec<V> f;
             current_faults.emplace(out_sig, f);
-            faulty_state.at(out_sig) = f.induce_fault(faulty_state.at(out_sig));
+            // Bit-flips of collapsed gates are added to the parity of their root
+            assert(materialized || is_collapsed(encoding, out_sig));
+            if (materialized)
+                faulty_state.at(out_sig) = f.induce_fault(faulty_state.at(out_sig));
         }
     }
 }
 
+template <typename V>
+void eval_xor_chain(const xor_chain_t& chain,
+                    const std::unordered_map<signal_id_t, V>& prev_golden_state,
+                    std::unordered_map<signal_id_t, V>& golden_state,
+                    const std::unordered_map<signal_id_t, V>& prev_faulty_state,
+                    std::unordered_map<signal_id_t, V>& faulty_state,
+                    const std::unordered_map<signal_id_t, fault_spec<V>>& current_faults)
+{
+    if (golden_state.find(chain.root) != golden_state.end() ||
+        faulty_state.find(chain.root) != faulty_state.end())
+    { throw std::logic_error(ILLEGAL_SIGNAL_OVERWRITE); }
+
+    // Golden root, possibly rewritten with previous roots. Keep the symbol of
+    // the previous clock cycle if the operands did not change
+    std::vector<V> golden_ops;
+    const auto& prev_root_g = prev_golden_state.find(chain.root);
+    bool same_as_prev = (prev_root_g != prev_golden_state.end());
+    for (const signal_id_t& sig : chain.ops)
+    {
+        const V& val = golden_state.at(sig);
+        golden_ops.push_back(val);
+        const auto& prev_it = prev_golden_state.find(sig);
+        same_as_prev = same_as_prev && prev_it != prev_golden_state.end() && prev_it->second == val;
+    }
+    const V golden_root = same_as_prev ? prev_root_g->second :
+                              make_parity(golden_ops, chain.ops_negated);
+    golden_state.emplace(chain.root, golden_root);
+
+    // Faulty root from its leaves and the bit-flips of collapsed gates.
+    // It shares the golden symbol if none of them differ. The previous symbol
+    // is only kept without collapsed gates, whose bit-flips change every cycle
+    std::vector<V> faulty_ops;
+    const auto& prev_root_f = prev_faulty_state.find(chain.root);
+    bool same_as_golden = true;
+    same_as_prev = (prev_root_f != prev_faulty_state.end()) && chain.inner.empty();
+    for (const signal_id_t& sig : chain.leaves)
+    {
+        const V& val = faulty_state.at(sig);
+        faulty_ops.push_back(val);
+        same_as_golden = same_as_golden && val == golden_state.at(sig);
+        const auto& prev_it = prev_faulty_state.find(sig);
+        same_as_prev = same_as_prev && prev_it != prev_faulty_state.end() && prev_it->second == val;
+    }
+    for (const signal_id_t& sig : chain.inner)
+    {
+        const auto& f = current_faults.find(sig);
+        if (f == current_faults.end()) continue;
+        faulty_ops.push_back(f->second.f0);
+        same_as_golden = same_as_prev = false;
+    }
+
+    if (same_as_golden) {
+        faulty_state.emplace(chain.root, golden_root);
+    } else if (same_as_prev) {
+        faulty_state.emplace(chain.root, prev_root_f->second);
+    } else {
+        faulty_state.emplace(chain.root, make_parity(faulty_ops, chain.negated));
+    }
+}
+
+template <typename V>
+void eval_lut(signal_id_t root, const lut_t& lut,
+              const std::unordered_map<signal_id_t, V>& prev_golden_state,
+              std::unordered_map<signal_id_t, V>& golden_state,
+              std::unordered_map<signal_id_t, V>& faulty_state)
+{
+    if (golden_state.find(root) != golden_state.end() ||
+        faulty_state.find(root) != faulty_state.end())
+    { throw std::logic_error(ILLEGAL_SIGNAL_OVERWRITE); }
+
+    // Golden root, keeping the symbol of the previous clock cycle if the
+    // leaves did not change
+    std::vector<V> golden_leaves;
+    const auto& prev_root_g = prev_golden_state.find(root);
+    bool same_as_prev = (prev_root_g != prev_golden_state.end());
+    for (const signal_id_t& sig : lut.leaves)
+    {
+        const V& val = golden_state.at(sig);
+        golden_leaves.push_back(val);
+        const auto& prev_it = prev_golden_state.find(sig);
+        same_as_prev = same_as_prev && prev_it != prev_golden_state.end() && prev_it->second == val;
+    }
+    const V golden_root = same_as_prev ? prev_root_g->second :
+                              make_lut(golden_leaves, lut.truth_table);
+    golden_state.emplace(root, golden_root);
+
+    // Faulty root, sharing the golden symbol if no leaf differs
+    std::vector<V> faulty_leaves;
+    bool same_as_golden = true;
+    for (const signal_id_t& sig : lut.leaves)
+    {
+        const V& val = faulty_state.at(sig);
+        faulty_leaves.push_back(val);
+        same_as_golden = same_as_golden && val == golden_state.at(sig);
+    }
+    faulty_state.emplace(root, same_as_golden ? golden_root :
+                               make_lut(faulty_leaves, lut.truth_table));
+}
+
+template <typename V>
 void assert_invariants_at_step(const Circuit& circuit,
-                               const std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+                               const std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
                                const std::unordered_map<std::string, std::vector<bool>> invariant_list,
                                const uint32_t step)
 {
@@ -467,23 +844,24 @@ void assert_invariants_at_step(const Circuit& circuit,
 
         assert(sig.size() == bitvec.size());
         for (uint32_t pos = 0; pos < sig.size(); pos++) {
-            var_t symbol = golden_trace.at(step).at(sig.at(pos));
+            V symbol = golden_trace.at(step).at(sig.at(pos));
             bool value = bitvec.at(pos);
-            cxxsat::solver->add_clause(value ? symbol : (!symbol));
+            add_clause_lits<V>({value ? symbol : (!symbol)});
         }
     }
 }
 
+template <typename V>
 void assert_no_alert_at_step(const Circuit& circuit,
-                             const std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
-                             const std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                             const std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                             const std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
                              const std::unordered_map<std::string, std::vector<bool>>& alert_list,
                              const uint32_t step)
 {
     assert(step < golden_trace.size());
     assert(golden_trace.size() == faulty_trace.size());
-    const std::unordered_map<signal_id_t, var_t>& golden_state = golden_trace.at(step);
-    const std::unordered_map<signal_id_t, var_t>& faulty_state = faulty_trace.at(step);
+    const std::unordered_map<signal_id_t, V>& golden_state = golden_trace.at(step);
+    const std::unordered_map<signal_id_t, V>& faulty_state = faulty_trace.at(step);
 
     for (const auto& alert: alert_list)
     {
@@ -491,18 +869,127 @@ void assert_no_alert_at_step(const Circuit& circuit,
         const std::vector<bool>& bitvec = alert.second;
         assert(sig.size() == bitvec.size());
 
-        std::vector<var_t> out_vars;
+        std::vector<V> out_vars;
         for (uint32_t pos = 0; pos < sig.size(); pos++) {
             bool value = bitvec.at(pos);
-            var_t g = golden_state.at(sig.at(pos));
-            var_t f = faulty_state.at(sig.at(pos));
+            V g = golden_state.at(sig.at(pos));
+            V f = faulty_state.at(sig.at(pos));
             out_vars.push_back(value ? g : (!g));
             out_vars.push_back(value ? f : (!f));
         }
-        cxxsat::solver->add_clause(cxxsat::solver->make_and(out_vars));
+        add_clause_lits<V>({make_and(out_vars)});
     }
 }
 
+template <typename V>
+void unroll_cycle(const Circuit& circuit,
+                  std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                  std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
+                  const std::unordered_set<signal_id_t>& f_sigs,
+                  std::vector<std::unordered_map<signal_id_t, fault_spec<V>>>& faults,
+                  const std::unordered_set<signal_id_t>& alert_signals,
+                  const std::unordered_map<std::string, std::vector<bool>>& invariant_list,
+                  const std::unordered_map<std::string, std::vector<bool>>& alert_list,
+                  const encoding_t& encoding)
+{
+    const uint32_t cycle = golden_trace.size();
+    if (cycle == 0)
+    {
+        unroll_init_with_faults(circuit, golden_trace, faulty_trace, f_sigs, faults, encoding);
+        // Assume invariant on golden trace
+        assert_invariants_at_step(circuit, golden_trace, invariant_list, 0);
+    } else {
+        unroll_with_faults(circuit, golden_trace, faulty_trace, f_sigs, faults,
+                           alert_signals, encoding);
+    }
+
+    // Assume no alert at each step
+    assert_no_alert_at_step(circuit, golden_trace, faulty_trace, alert_list, cycle);
+}
+
+bool unroll_with_cnf_cache(const Circuit& circuit,
+                           std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+                           std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                           const std::unordered_set<signal_id_t>& f_sigs,
+                           std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults,
+                           const std::unordered_set<signal_id_t>& alert_signals,
+                           const std::unordered_map<std::string, std::vector<bool>>& invariant_list,
+                           const std::unordered_map<std::string, std::vector<bool>>& alert_list,
+                           const encoding_t& encoding, const uint32_t depth,
+                           const std::string& cache_file, const std::string& key,
+                           cnf_unrolling_t* kept)
+{
+    assert(golden_trace.empty());
+    assert(faulty_trace.empty());
+    assert(faults.empty());
+
+    cnf_unrolling_t unrolling;
+    const bool cached = !cache_file.empty() && load_cnf_unrolling(cache_file, key, unrolling);
+    if (!cached)
+    {
+        unrolling = cnf_unrolling_t();
+        std::vector<std::unordered_map<signal_id_t, fault_spec<lit_t>>> lit_faults;
+        cnf_builder = &unrolling.cnf;
+        for (uint32_t cycle = 0; cycle <= depth; cycle++)
+            unroll_cycle(circuit, unrolling.golden_trace, unrolling.faulty_trace, f_sigs,
+                         lit_faults, alert_signals, invariant_list, alert_list, encoding);
+        cnf_builder = nullptr;
+
+        for (const auto& current_faults : lit_faults)
+        {
+            unrolling.faults.emplace_back();
+            for (const auto& it : current_faults)
+                unrolling.faults.back().emplace(it.first, it.second.f0);
+        }
+        if (!cache_file.empty()) save_cnf_unrolling(cache_file, key, unrolling);
+    }
+    assert(unrolling.golden_trace.size() == depth + 1);
+
+    // Translate the literals of the CNF to the ones of the solver. Signals are
+    // inserted in increasing order, so that saving and loading runs iterate
+    // over the traces in the same order
+    const std::vector<var_t> vars = unrolling.cnf.load_into_solver();
+    auto sorted = [](const std::unordered_map<signal_id_t, lit_t>& state)
+    {
+        std::vector<std::pair<signal_id_t, lit_t>> entries(state.begin(), state.end());
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b)
+            { return a.first < b.first; });
+        return entries;
+    };
+    for (uint32_t cycle = 0; cycle <= depth; cycle++)
+    {
+        golden_trace.emplace_back();
+        faulty_trace.emplace_back();
+        faults.emplace_back();
+        for (const auto& it : sorted(unrolling.golden_trace.at(cycle)))
+            golden_trace.back().emplace(it.first, to_solver(vars, it.second));
+        for (const auto& it : sorted(unrolling.faulty_trace.at(cycle)))
+            faulty_trace.back().emplace(it.first, to_solver(vars, it.second));
+        for (const auto& it : sorted(unrolling.faults.at(cycle)))
+            faults.back().emplace(it.first, fault_spec_t(to_solver(vars, it.second)));
+    }
+    if (kept) *kept = std::move(unrolling);
+    return cached;
+}
+
+template void unroll_cycle<var_t>(const Circuit&,
+    std::vector<std::unordered_map<signal_id_t, var_t>>&,
+    std::vector<std::unordered_map<signal_id_t, var_t>>&,
+    const std::unordered_set<signal_id_t>&,
+    std::vector<std::unordered_map<signal_id_t, fault_spec_t>>&,
+    const std::unordered_set<signal_id_t>&,
+    const std::unordered_map<std::string, std::vector<bool>>&,
+    const std::unordered_map<std::string, std::vector<bool>>&,
+    const encoding_t&);
+template void init_constants<var_t>(std::unordered_map<signal_id_t, var_t>&);
+template void assert_invariants_at_step<var_t>(const Circuit&,
+    const std::vector<std::unordered_map<signal_id_t, var_t>>&,
+    const std::unordered_map<std::string, std::vector<bool>>, uint32_t);
+template void assert_no_alert_at_step<var_t>(const Circuit&,
+    const std::vector<std::unordered_map<signal_id_t, var_t>>&,
+    const std::vector<std::unordered_map<signal_id_t, var_t>>&,
+    const std::unordered_map<std::string, std::vector<bool>>&, uint32_t);
+
 void assume_no_comb_fault_if_not_connected_to_outputs(
                 const Circuit& circuit,
                 const std::unordered_map<signal_id_t, fault_spec_t>& comb_faults)
@@ -518,18 +1005,22 @@ void assume_no_comb_fault_if_not_connected_to_outputs(
     std::cout << " / " << comb_faults.size() << std::endl;
 }
 
-const var_t fault_spec_t::induce_fault(const var_t normal)
+template <typename V>
+const V fault_spec<V>::induce_fault(const V normal)
 {
-    var_t new_value = cxxsat::solver->new_var();
+    V new_value = new_var<V>();
     // 0 no fault
-    cxxsat::solver->add_clause( normal,  f0, -new_value);
-    cxxsat::solver->add_clause(-normal,  f0,  new_value);
+    add_clause_lits<V>({ normal,  f0, -new_value});
+    add_clause_lits<V>({-normal,  f0,  new_value});
     // 1 bit flip
-    cxxsat::solver->add_clause( normal,  -f0, new_value);
-    cxxsat::solver->add_clause(-normal, -f0, -new_value);
+    add_clause_lits<V>({ normal,  -f0, new_value});
+    add_clause_lits<V>({-normal, -f0, -new_value});
     return new_value;
 }
 
+template struct fault_spec<var_t>;
+template struct fault_spec<lit_t>;
+
 std::vector<std::unordered_set<signal_id_t>> init_partitions_from_file(const Circuit& circuit,
                                                                 const std::string file_name)
 {
@@ -724,13 +1215,72 @@ bool at_least_2_conn_parts(
     return false;
 }
 
+template <typename V, typename F, typename L>
+static std::vector<V> free_vars(const Circuit& circuit,
+                                const std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                                const std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
+                                const std::vector<std::unordered_map<signal_id_t, F>>& comb_faults,
+                                const L& fault_lit)
+{
+    std::vector<V> vars;
+    for (uint32_t cycle = 0; cycle < golden_trace.size(); cycle++)
+    {
+        for (const auto* sigs : {&circuit.ins(), &circuit.regs()})
+        {
+            for (const signal_id_t sig : *sigs)
+            {
+                const auto& it_g = golden_trace.at(cycle).find(sig);
+                const auto& it_f = faulty_trace.at(cycle).find(sig);
+                if (it_g != golden_trace.at(cycle).end()) vars.push_back(it_g->second);
+                if (it_f != faulty_trace.at(cycle).end()) vars.push_back(it_f->second);
+            }
+        }
+    }
+    // Faults by signal, so that the order does not depend on the hash tables
+    for (const auto& cycle_faults : comb_faults)
+    {
+        std::vector<signal_id_t> sigs;
+        for (const auto& m_sig_fault : cycle_faults) sigs.push_back(m_sig_fault.first);
+        std::sort(sigs.begin(), sigs.end());
+        for (const signal_id_t sig : sigs)
+            vars.push_back(fault_lit(cycle_faults.at(sig)));
+    }
+    return vars;
+}
+
+std::vector<var_t> unrolling_free_vars(
+    const Circuit& circuit,
+    const std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+    const std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+    const std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& comb_faults)
+{
+    return free_vars(circuit, golden_trace, faulty_trace, comb_faults,
+                     [](const fault_spec_t& fault) { return fault.f0; });
+}
+
+std::vector<lit_t> unrolling_free_lits(const Circuit& circuit, const cnf_unrolling_t& unrolling)
+{
+    return free_vars(circuit, unrolling.golden_trace, unrolling.faulty_trace, unrolling.faults,
+                     [](lit_t fault) { return fault; });
+}
+
 std::stringstream optim_at_least_2_conn_parts(
     const Circuit& circuit,
     const std::vector<std::unordered_set<signal_id_t>>& partitions,
     const std::unordered_map<signal_id_t, fault_spec_t>& initial_comb_faults,
-    const std::vector<var_t>& initial_partitions_diff)
+    const std::unordered_map<signal_id_t, var_t>& initial_reg_diffs,
+    const std::unordered_map<signal_id_t, std::unordered_set<signal_id_t>>* functional_conn_regs)
 {
     std::stringstream ss;
+    const auto conn_regs = [&circuit, functional_conn_regs](signal_id_t sig)
+    {
+        if (functional_conn_regs != nullptr) {
+            const auto& f = functional_conn_regs->find(sig);
+            if (f != functional_conn_regs->end()) return &f->second;
+        }
+        return circuit.get_conn_regs(sig);
+    };
+
     // Map register id with partition index
     std::unordered_map<signal_id_t, uint32_t> m_reg_partidx;
     m_reg_partidx.reserve(circuit.regs().size());
@@ -741,19 +1291,21 @@ std::stringstream optim_at_least_2_conn_parts(
         }
     }
 
-    // No faulted partition if connected to at most 1 partition
+    // No faulted partition if connected to at most 1 partition. The clauses are
+    // asserted on registers to outlive the partition difference once merged
     int part_optim_nb = 0;
     for (uint32_t idx = 0; idx < partitions.size(); idx++) {
 
         // Build a set of adjacent registers to the current partition
         std::unordered_set<signal_id_t> adjacent_regs;
         for (const signal_id_t& sig : partitions.at(idx)) {
-            const auto& set = circuit.get_conn_regs(sig);
+            const auto& set = conn_regs(sig);
             adjacent_regs.insert(set->begin(), set->end());
         }
 
         if (adjacent_regs.size() <= 1) {
-            cxxsat::solver->add_clause(!initial_partitions_diff.at(idx));
+            for (const signal_id_t reg : partitions.at(idx))
+                cxxsat::solver->add_clause(!initial_reg_diffs.at(reg));
             part_optim_nb++;
             continue;
         }
@@ -766,7 +1318,8 @@ std::stringstream optim_at_least_2_conn_parts(
         }
         
         if (it == adjacent_regs.end()) {
-            cxxsat::solver->add_clause(!initial_partitions_diff.at(idx));
+            for (const signal_id_t reg : partitions.at(idx))
+                cxxsat::solver->add_clause(!initial_reg_diffs.at(reg));
             part_optim_nb++;
         }
     }
@@ -776,7 +1329,7 @@ std::stringstream optim_at_least_2_conn_parts(
     int comb_optim_nb = 0;
     for (const auto& sig_fault : initial_comb_faults) {
         // Get connected registers to the current signal
-        const std::unordered_set<signal_id_t>& adjacent_regs = *circuit.get_conn_regs(sig_fault.first);
+        const std::unordered_set<signal_id_t>& adjacent_regs = *conn_regs(sig_fault.first);
 
         if (adjacent_regs.size() <= 1) {
             cxxsat::solver->add_clause(!sig_fault.second.is_faulted());
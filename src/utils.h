@@ -26,6 +26,10 @@
 #include "Circuit.h"
 #include "vars.h"
 #include "Solver.h"
+#include "xor_chains.h"
+#include "cut_cover.h"
+#include "sweeping.h"
+#include "cnf.h"
 
 using var_t = cxxsat::var_t;
 
@@ -64,13 +68,16 @@ const var_t fault_spec_t::induce_fault(const var_t normal)
     return new_value;
 }
 #else
-struct fault_spec_t {
+template <typename V>
+struct fault_spec {
     // 0 = no fault, 1 = bit-flip
-    var_t f0;
-    fault_spec_t() : f0(cxxsat::solver->new_var()) {}
-    const var_t is_faulted() const { return f0; }
-    const var_t induce_fault(var_t normal);
+    V f0;
+    fault_spec() : f0(new_var<V>()) {}
+    explicit fault_spec(const V& f) : f0(f) {}
+    const V is_faulted() const { return f0; }
+    const V induce_fault(V normal);
 };
+using fault_spec_t = fault_spec<var_t>;
 #endif
 
 inline std::ostream& show_diff(std::ostream& out, const std::string& vcd_id, bool val_g, bool val_f)
@@ -82,6 +89,33 @@ inline std::ostream& show_diff(std::ostream& out, const std::string& vcd_id, boo
     return out;
 }
 
+///////////   Model_t   ////////////////////////////////////////////////////////
+// Values of a list of literals in the last model of the solver, read once and
+// packed in a bitset, so that readers scan memory instead of querying the
+// solver literal by literal
+
+class model_t
+{
+private:
+    std::vector<uint64_t> m_bits;
+    size_t m_size = 0;
+
+public:
+    model_t() = default;
+    // All false
+    explicit model_t(size_t size) : m_bits((size + 63) / 64, 0), m_size(size) {};
+    explicit model_t(const std::vector<var_t>& lits);
+    size_t size() const { return m_size; }
+    bool operator[](size_t idx) const { return (m_bits[idx >> 6] >> (idx & 63)) & 1; }
+    void set(size_t idx) { m_bits[idx >> 6] |= uint64_t(1) << (idx & 63); }
+    // Indices of the true literals in [beg, end), relative to `beg`
+    std::vector<uint32_t> true_indexes(size_t beg, size_t end) const;
+};
+
+// Values of `sigs` in `state`, signals missing from it being false
+model_t read_state(const std::unordered_map<signal_id_t, var_t>& state,
+                   const std::vector<signal_id_t>& sigs);
+
 std::string replace_all(const std::string& s, const std::string& x, const std::string& y);
 
 void dump_vcd(const std::string& file_name, const Circuit& circ,
@@ -98,29 +132,116 @@ std::stringstream partition_info(const Circuit& circuit,
                           const std::vector<std::unordered_set<signal_id_t>>& partitions,
                           const std::vector<std::string>& interesting_names);
 
+///////////   Encoding_t   ///////////////////////////////////////////////////
+// Optional encodings of the transition relation used while unrolling:
+//  - `xor_chains` encodes XOR trees as parity constraints
+//  - `cut_cover` encodes non-faultable logic cones as LUTs
+//  - `sweeping` reuses the golden value of equivalent signals
+//  - `delta` encodes faulty gates as their golden value XOR a propagated delta
+
+struct encoding_t
+{
+    const xor_chains_t* xor_chains = nullptr;
+    const cut_cover_t* cut_cover = nullptr;
+    const sweeping_t* sweeping = nullptr;
+    bool delta = false;
+};
+
+// Maximal number of operands of a node of a guarded OR
+#define GUARDED_OR_FANIN 5
+
+/*  OR of `ops` whose definition only holds when `act` is assumed.
+ *  Adding the clause `!act` retires the definition: all its clauses are then
+ *  satisfied and the solver may discard them
+ */
+var_t make_guarded_or(const std::vector<var_t>& ops, const var_t& act);
+
+/*  Literal implying that at most `k` of `ops` are true, encoded as a
+ *  sequential counter rather than with the encoding of the solver
+ */
+var_t make_seq_at_most(const std::vector<var_t>& ops, uint32_t k);
+
 /*  golden_trace and faulty_trace are initialized with different initial states ;
  *  inputs are the same but internal value of registers are different
  */
+template <typename V>
 void unroll_init_with_faults(const Circuit& circuit,
-                             std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
-                             std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                             std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                             std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
                              const std::unordered_set<signal_id_t>& faultable_sigs,
-                             std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults);
+                             std::vector<std::unordered_map<signal_id_t, fault_spec<V>>>& faults,
+                             const encoding_t& encoding = encoding_t());
 
+template <typename V>
 void unroll_with_faults(const Circuit& circuit,
-                        std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
-                        std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                        std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                        std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
                         const std::unordered_set<signal_id_t>& faultable_sigs,
-                        std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults,
-                        const std::unordered_set<signal_id_t>& alert_signals);
+                        std::vector<std::unordered_map<signal_id_t, fault_spec<V>>>& faults,
+                        const std::unordered_set<signal_id_t>& alert_signals,
+                        const encoding_t& encoding = encoding_t());
+
+/*  Unroll the next clock cycle, assuming the invariants on the first one and
+ *  no alert on every one
+ */
+template <typename V>
+void unroll_cycle(const Circuit& circuit,
+                  std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                  std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
+                  const std::unordered_set<signal_id_t>& faultable_sigs,
+                  std::vector<std::unordered_map<signal_id_t, fault_spec<V>>>& faults,
+                  const std::unordered_set<signal_id_t>& alert_signals,
+                  const std::unordered_map<std::string, std::vector<bool>>& invariant_list,
+                  const std::unordered_map<std::string, std::vector<bool>>& alert_list,
+                  const encoding_t& encoding = encoding_t());
 
-void init_constants(std::unordered_map<signal_id_t, var_t>& state);
+/*  Unroll the first `depth` + 1 clock cycles in a CNF and save it in
+ *  `cache_file`, or load it from there if a previous run saved it under the
+ *  same `key` (no cache if empty). The CNF is then loaded in the solver, and
+ *  kept in `kept` when given.
+ *  Returns true if the unrolling was loaded from the cache
+ */
+bool unroll_with_cnf_cache(const Circuit& circuit,
+                           std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+                           std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                           const std::unordered_set<signal_id_t>& faultable_sigs,
+                           std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& faults,
+                           const std::unordered_set<signal_id_t>& alert_signals,
+                           const std::unordered_map<std::string, std::vector<bool>>& invariant_list,
+                           const std::unordered_map<std::string, std::vector<bool>>& alert_list,
+                           const encoding_t& encoding, uint32_t depth,
+                           const std::string& cache_file, const std::string& key,
+                           cnf_unrolling_t* kept = nullptr);
+
+/*  Evaluate the root of an XOR chain in the golden and faulty states.
+ *  Bit-flips on collapsed gates of the chain must already be in `current_faults`
+ */
+template <typename V>
+void eval_xor_chain(const xor_chain_t& chain,
+                    const std::unordered_map<signal_id_t, V>& prev_golden_state,
+                    std::unordered_map<signal_id_t, V>& golden_state,
+                    const std::unordered_map<signal_id_t, V>& prev_faulty_state,
+                    std::unordered_map<signal_id_t, V>& faulty_state,
+                    const std::unordered_map<signal_id_t, fault_spec<V>>& current_faults);
+
+/*  Evaluate the root of a LUT in the golden and faulty states.
+ *  Absorbed gates are never faulted, so the faulty LUT only depends on its leaves
+ */
+template <typename V>
+void eval_lut(signal_id_t root, const lut_t& lut,
+              const std::unordered_map<signal_id_t, V>& prev_golden_state,
+              std::unordered_map<signal_id_t, V>& golden_state,
+              std::unordered_map<signal_id_t, V>& faulty_state);
+
+template <typename V>
+void init_constants(std::unordered_map<signal_id_t, V>& state);
 
 /*  Assert invariants on signals defined in the body of the function.
  *  This applies to the golden trace only
  */
+template <typename V>
 void assert_invariants_at_step(const Circuit& circuit,
-                               const std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+                               const std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
                                const std::unordered_map<std::string, std::vector<bool>> invariant_list,
                                uint32_t step);
 
@@ -130,9 +251,10 @@ void assume_no_comb_fault_if_not_connected_to_outputs(const Circuit& circuit,
 /*  Assert invariants on signals defined in the body of the function.
  *  This applies to both golden_trace and faulty_trace
  */
+template <typename V>
 void assert_no_alert_at_step(const Circuit& circuit,
-                             const std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
-                             const std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+                             const std::vector<std::unordered_map<signal_id_t, V>>& golden_trace,
+                             const std::vector<std::unordered_map<signal_id_t, V>>& faulty_trace,
                              const std::unordered_map<std::string, std::vector<bool>>& alert_list,
                              uint32_t step);
 
@@ -169,10 +291,27 @@ bool at_least_2_conn_parts(
     const std::vector<std::unordered_set<signal_id_t>>& partitions,
     const signal_id_t& sig);
 
+/*  Inputs and registers of the unrolled traces with the fault variables: the
+ *  other variables of the unrolling follow from their values. Their order only
+ *  depends on the circuit and the unrolled cycles
+ */
+std::vector<var_t> unrolling_free_vars(
+    const Circuit& circuit,
+    const std::vector<std::unordered_map<signal_id_t, var_t>>& golden_trace,
+    const std::vector<std::unordered_map<signal_id_t, var_t>>& faulty_trace,
+    const std::vector<std::unordered_map<signal_id_t, fault_spec_t>>& comb_faults);
+
+// Same for a CNF unrolling, in the order of the solver unrolling loaded from it
+std::vector<lit_t> unrolling_free_lits(const Circuit& circuit, const cnf_unrolling_t& unrolling);
+
+/*  Registers connected to a signal are taken from `functional_conn_regs`
+ *  when it has an entry for the signal
+ */
 std::stringstream optim_at_least_2_conn_parts(
     const Circuit& circuit,
     const std::vector<std::unordered_set<signal_id_t>>& partitions,
     const std::unordered_map<signal_id_t, fault_spec_t>& initial_comb_faults,
-    const std::vector<var_t>& initial_partitions_diff);
+    const std::unordered_map<signal_id_t, var_t>& initial_reg_diffs,
+    const std::unordered_map<signal_id_t, std::unordered_set<signal_id_t>>* functional_conn_regs = nullptr);
 
 #endif // VERIFIER_UTILS_H
@@ -0,0 +1,183 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "workqueue.h"
+#include "utils.h"
+#include "json.hpp"
+
+// Files are written aside and renamed, so that readers never see them partially
+static void write_atomically(const std::string& file_name, const std::string& data)
+{
+    const std::string tmp_name = file_name + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream f(tmp_name);
+    f << data;
+    f.close();
+    std::filesystem::rename(tmp_name, file_name);
+}
+
+static void wait_for(const std::string& file_name)
+{
+    while (!std::filesystem::exists(file_name))
+        std::this_thread::sleep_for(std::chrono::milliseconds(WORK_QUEUE_POLL_MS));
+}
+
+static std::string host_name()
+{
+    char name[256] = {0};
+    gethostname(name, sizeof(name) - 1);
+    return name;
+}
+
+/*  Whether the claimant of `claim_name` is gone: its claim was not refreshed
+ *  for `WORK_QUEUE_STALE_MS`, or its process no longer exists on this host.
+ *  A claim whose claimant died before writing it times out like any other
+ */
+static bool is_stale(const std::string& claim_name)
+{
+    std::error_code ec;
+    const auto date = std::filesystem::last_write_time(claim_name, ec);
+    if (ec) return false;
+    const auto age = std::filesystem::file_time_type::clock::now() - date;
+    if (age > std::chrono::milliseconds(WORK_QUEUE_STALE_MS)) return true;
+
+    std::ifstream f(claim_name);
+    std::string host;
+    pid_t pid = 0;
+    if (!(f >> host >> pid)) return false;
+    return host == host_name() && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+void WorkQueue::post(const std::vector<std::unordered_set<signal_id_t>>& partitions, uint32_t num_items)
+{
+    for (const char* sub : {"partitions.json", "pending", "claimed", "done"})
+        std::filesystem::remove_all(m_dir + "/" + sub);
+    for (const char* sub : {"pending", "claimed", "done"})
+        std::filesystem::create_directories(m_dir + "/" + sub);
+
+    for (uint32_t item = 0; item < num_items; item++)
+        write_atomically(m_dir + "/pending/" + std::to_string(item), "");
+
+    // Last, as workers start from it. An array keeps the order of partitions
+    nlohmann::json j = nlohmann::json::array();
+    for (const auto& partition : partitions)
+    {
+        std::vector<signal_id_t> sorted(partition.begin(), partition.end());
+        std::sort(sorted.begin(), sorted.end());
+        j.push_back(sorted);
+    }
+    write_atomically(m_dir + "/partitions.json", j.dump());
+}
+
+std::vector<std::unordered_set<signal_id_t>> WorkQueue::wait_partitions(const Circuit& circuit) const
+{
+    wait_for(m_dir + "/partitions.json");
+    return init_partitions_from_file(circuit, m_dir + "/partitions.json");
+}
+
+bool WorkQueue::claim(uint32_t& item) const
+{
+    std::vector<uint32_t> pending;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(m_dir + "/pending", ec))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.find('.') == std::string::npos) pending.push_back(std::stoul(name));
+    }
+    std::sort(pending.begin(), pending.end());
+
+    for (const uint32_t candidate : pending)
+    {
+        const std::string name = std::to_string(candidate);
+        // The claim is dated from now, not from the enqueueing of the item
+        std::filesystem::last_write_time(m_dir + "/pending/" + name, std::filesystem::file_time_type::clock::now(), ec);
+        if (ec) continue;
+        std::filesystem::rename(m_dir + "/pending/" + name, m_dir + "/claimed/" + name, ec);
+        if (!ec) {
+            std::ofstream f(m_dir + "/claimed/" + name);
+            f << host_name() << " " << getpid() << " " << std::time(nullptr) << std::endl;
+            item = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+pid_t WorkQueue::keep_alive(uint32_t item) const
+{
+    const pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    // Dies with the claimant
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    const std::string claim_name = m_dir + "/claimed/" + std::to_string(item);
+    for (;;)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WORK_QUEUE_HEARTBEAT_MS));
+        std::error_code ec;
+        std::filesystem::last_write_time(claim_name, std::filesystem::file_time_type::clock::now(), ec);
+    }
+}
+
+void WorkQueue::release(pid_t keeper) const
+{
+    if (keeper <= 0) return;
+    kill(keeper, SIGKILL);
+    waitpid(keeper, nullptr, 0);
+}
+
+void WorkQueue::complete(uint32_t item, const std::string& result) const
+{
+    write_atomically(m_dir + "/done/" + std::to_string(item), result);
+}
+
+std::string WorkQueue::wait_result(uint32_t item, const std::function<void()>& on_requeue) const
+{
+    const std::string name = std::to_string(item);
+    const std::string file_name = m_dir + "/done/" + name;
+    while (!std::filesystem::exists(file_name))
+    {
+        // The result may have been written since the claim was found stale
+        std::error_code ec;
+        if (is_stale(m_dir + "/claimed/" + name) && !std::filesystem::exists(file_name)) {
+            std::filesystem::rename(m_dir + "/claimed/" + name, m_dir + "/pending/" + name, ec);
+            if (!ec) on_requeue();
+            continue;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(WORK_QUEUE_POLL_MS));
+    }
+    std::ifstream f(file_name);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+void WorkQueue::retire() const
+{
+    std::filesystem::remove(m_dir + "/partitions.json");
+}
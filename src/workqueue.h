@@ -0,0 +1,84 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_WORKQUEUE_H
+#define VERIFIER_WORKQUEUE_H
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "Circuit.h"
+
+constexpr const char* ILLEGAL_WORKER_QUEUE = "Worker started without `work_queue` in configuration";
+
+// Delay between two looks at the queue directory
+#define WORK_QUEUE_POLL_MS 100
+
+// Delay between two refreshes of a claim by its claimant, and age of the last
+// refresh after which the claimant is taken for dead
+#define WORK_QUEUE_HEARTBEAT_MS 5000
+#define WORK_QUEUE_STALE_MS 60000
+
+///////////   WorkQueue   //////////////////////////////////////////////////////
+// Work items shared through a directory, possibly on a shared file system, by
+// a coordinator and any number of worker processes:
+//  - `partitions.json` holds the partitions the items are checked against
+//  - `pending/<item>` is claimed by renaming it to `claimed/<item>`, which
+//    succeeds for a single process. The claim then records the host, the pid
+//    and the time of the claimant, which refreshes its date while it checks
+//    the item
+//  - `done/<item>` holds the result of the item
+// A claim whose claimant died, as seen on its host or by a date older than
+// `WORK_QUEUE_STALE_MS`, goes back to `pending/`
+// Items are indices known to both sides, here the Procedure 2 splits of the
+// same configuration
+
+class WorkQueue
+{
+private:
+    std::string m_dir;
+
+public:
+    explicit WorkQueue(const std::string& dir) : m_dir(dir) {};
+
+    // Coordinator: clear the directory, then post the items and the partitions
+    void post(const std::vector<std::unordered_set<signal_id_t>>& partitions, uint32_t num_items);
+
+    // Worker: wait for the partitions of the coordinator
+    std::vector<std::unordered_set<signal_id_t>> wait_partitions(const Circuit& circuit) const;
+
+    // Claim the first pending item, returns false when none is left
+    bool claim(uint32_t& item) const;
+
+    // Refresh the claim of `item` from a forked process until `release`
+    pid_t keep_alive(uint32_t item) const;
+    void release(pid_t keeper) const;
+
+    void complete(uint32_t item, const std::string& result) const;
+
+    // Coordinator: wait for the result of an item. When its claim is stale,
+    // the item goes back to `pending/` and `on_requeue` is called, so that
+    // the coordinator can check it itself
+    std::string wait_result(uint32_t item, const std::function<void()>& on_requeue) const;
+
+    // Coordinator: withdraw the partitions, so that late workers do not pick
+    // them up as those of the next run
+    void retire() const;
+};
+
+#endif // VERIFIER_WORKQUEUE_H
@@ -0,0 +1,272 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#include <algorithm>
+
+#include "xor_chains.h"
+#include "utils.h"
+
+static_assert(XOR_CUT >= 2 && XOR_CUT <= 4, "XOR_CUT must be between 2 and 4");
+
+static bool is_xor_gate(const Cell* cell)
+{
+    return is_binary(cell->type()) && gate_is_like_xor(cell->type());
+}
+
+// Symmetric difference of two sorted vectors, i.e. their sum over GF(2)
+static std::vector<uint32_t> gf2_add(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+{
+    std::vector<uint32_t> sum;
+    sum.reserve(a.size() + b.size());
+    std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(),
+                                  std::back_inserter(sum));
+    return sum;
+}
+
+xor_chains_t extract_xor_chains(const Circuit& circuit,
+                                const std::unordered_set<signal_id_t>& kept_sigs)
+{
+    xor_chains_t xor_chains;
+
+    // An XOR gate is collapsed into its reader if it is the only cell reading it
+    // and this cell is an XOR gate reading it once
+    for (const Cell* cell : circuit.cells())
+    {
+        if (!is_xor_gate(cell)) continue;
+        const signal_id_t out_y = cell->ports().m_bin.m_out_y;
+        if (kept_sigs.find(out_y) != kept_sigs.end()) continue;
+        if (circuit.outs().find(out_y) != circuit.outs().end()) continue;
+
+        const auto& fanout = circuit.get_fanout(out_y);
+        if (fanout.size() != 1) continue;
+        const Cell* reader = *fanout.begin();
+        if (!is_xor_gate(reader)) continue;
+        if (reader->ports().m_bin.m_in_a == reader->ports().m_bin.m_in_b) continue;
+        xor_chains.inner.emplace(out_y);
+    }
+
+    // Map XOR outputs to their cells to walk the trees
+    std::unordered_map<signal_id_t, const Cell*> xor_cells;
+    for (const Cell* cell : circuit.cells())
+    {
+        if (is_xor_gate(cell)) xor_cells.emplace(cell->ports().m_bin.m_out_y, cell);
+    }
+
+    // Build the chain of every remaining XOR gate, in topological order
+    std::vector<signal_id_t> root_order;
+    for (const Cell* cell : circuit.cells())
+    {
+        if (!is_xor_gate(cell)) continue;
+        const signal_id_t root = cell->ports().m_bin.m_out_y;
+        if (xor_chains.inner.find(root) != xor_chains.inner.end()) continue;
+
+        xor_chain_t chain;
+        chain.root = root;
+        chain.negated = false;
+
+        std::unordered_set<signal_id_t> odd_leaves;
+        std::vector<const Cell*> to_visit = {cell};
+        while (!to_visit.empty())
+        {
+            const Cell* curr = to_visit.back();
+            to_visit.pop_back();
+            chain.negated ^= is_out_negated(curr->type());
+
+            for (signal_id_t in : {curr->ports().m_bin.m_in_a, curr->ports().m_bin.m_in_b})
+            {
+                if (xor_chains.inner.find(in) != xor_chains.inner.end()) {
+                    chain.inner.push_back(in);
+                    to_visit.push_back(xor_cells.at(in));
+                } else if (in == signal_id_t::S_1) {
+                    chain.negated = !chain.negated;
+                } else if (in != signal_id_t::S_0 && in != signal_id_t::S_X &&
+                           in != signal_id_t::S_Z) {
+                    // A leaf read twice cancels out
+                    if (!odd_leaves.erase(in)) odd_leaves.emplace(in);
+                }
+            }
+        }
+        chain.leaves.assign(odd_leaves.begin(), odd_leaves.end());
+        std::sort(chain.leaves.begin(), chain.leaves.end());
+        chain.ops = chain.leaves;
+        chain.ops_negated = chain.negated;
+
+        xor_chains.roots.emplace(root, chain);
+        root_order.push_back(root);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    //      Gauss-Jordan elimination over the parity of the roots
+    ////////////////////////////////////////////////////////////////////////////
+    // Each row of the basis is a sum of roots (`combo`) whose leaves reduce to
+    // `cols`. The basis is kept in reduced row echelon form, so that a root is
+    // reduced by adding the rows pivoting on its leaves. A root is rewritten
+    // when its reduced form needs fewer operands than its leaves.
+
+    struct row_t
+    {
+        std::vector<uint32_t> cols;
+        std::vector<uint32_t> combo;
+        bool negated;
+    };
+    std::vector<row_t> rows;
+    std::unordered_map<uint32_t, uint32_t> pivot_rows;
+    std::unordered_map<uint32_t, std::unordered_set<uint32_t>> col_rows;
+
+    std::unordered_map<signal_id_t, uint32_t> col_of_leaf;
+    std::vector<signal_id_t> leaf_of_col;
+
+    auto add_to_row = [&](uint32_t row_idx, const row_t& other)
+    {
+        row_t& row = rows.at(row_idx);
+        for (uint32_t col : other.cols)
+        {
+            auto& occurrences = col_rows[col];
+            if (!occurrences.erase(row_idx)) occurrences.emplace(row_idx);
+        }
+        row.cols = gf2_add(row.cols, other.cols);
+        row.combo = gf2_add(row.combo, other.combo);
+        row.negated ^= other.negated;
+    };
+
+    for (uint32_t root_idx = 0; root_idx < root_order.size(); root_idx++)
+    {
+        xor_chain_t& chain = xor_chains.roots.at(root_order.at(root_idx));
+
+        std::vector<uint32_t> cols;
+        cols.reserve(chain.leaves.size());
+        for (signal_id_t leaf : chain.leaves)
+        {
+            const auto emplace_it = col_of_leaf.emplace(leaf, leaf_of_col.size());
+            if (emplace_it.second) leaf_of_col.push_back(leaf);
+            cols.push_back(emplace_it.first->second);
+        }
+        std::sort(cols.begin(), cols.end());
+
+        // Reduce the root with the current basis
+        row_t reduced = {cols, {}, false};
+        for (uint32_t col : cols)
+        {
+            const auto& f = pivot_rows.find(col);
+            if (f == pivot_rows.end()) continue;
+            const row_t& pivot_row = rows.at(f->second);
+            reduced.cols = gf2_add(reduced.cols, pivot_row.cols);
+            reduced.combo = gf2_add(reduced.combo, pivot_row.combo);
+            reduced.negated ^= pivot_row.negated;
+        }
+
+        if (reduced.cols.size() + reduced.combo.size() < cols.size())
+        {
+            chain.ops.clear();
+            for (uint32_t idx : reduced.combo) chain.ops.push_back(root_order.at(idx));
+            for (uint32_t col : reduced.cols) chain.ops.push_back(leaf_of_col.at(col));
+            chain.ops_negated = chain.negated ^ reduced.negated;
+            xor_chains.rewritten++;
+        }
+
+        if (reduced.cols.empty() || reduced.cols.size() > XOR_MAX_ROW) continue;
+
+        // Insert the reduced root and eliminate its pivot from the other rows
+        reduced.combo = gf2_add(reduced.combo, {root_idx});
+        reduced.negated ^= chain.negated;
+        const uint32_t pivot = reduced.cols.front();
+        const uint32_t new_idx = rows.size();
+
+        std::vector<uint32_t> to_eliminate(col_rows[pivot].begin(), col_rows[pivot].end());
+        for (uint32_t row_idx : to_eliminate) add_to_row(row_idx, reduced);
+
+        rows.push_back(reduced);
+        for (uint32_t col : reduced.cols) col_rows[col].emplace(new_idx);
+        pivot_rows.emplace(pivot, new_idx);
+    }
+
+    return xor_chains;
+}
+
+std::stringstream xor_chains_info(const xor_chains_t& xor_chains)
+{
+    std::stringstream ss;
+    uint32_t num_leaves = 0;
+    uint32_t max_leaves = 0;
+    for (const auto& it : xor_chains.roots)
+    {
+        num_leaves += it.second.leaves.size();
+        max_leaves = std::max(max_leaves, (uint32_t)it.second.leaves.size());
+    }
+    ss << "******* XOR chains ********" << std::endl;
+    ss << "Roots: " << xor_chains.roots.size() << std::endl;
+    ss << "Collapsed gates: " << xor_chains.inner.size() << std::endl;
+    ss << "Leaves: " << num_leaves << " (max " << max_leaves << ")" << std::endl;
+    ss << "Rewritten by elimination: " << xor_chains.rewritten << std::endl;
+    return ss;
+}
+
+// y = x_0 ^ ... ^ x_n, encoded by forbidding every assignment of odd parity
+template <typename V>
+static V make_parity_block(const std::vector<V>& ops)
+{
+    V y = new_var<V>();
+    std::vector<V> vars(ops);
+    vars.push_back(y);
+
+    std::vector<V> lits(vars.size());
+    for (uint32_t mask = 0; mask < (1U << vars.size()); mask++)
+    {
+        if (!(__builtin_popcount(mask) & 1)) continue;
+        for (uint32_t pos = 0; pos < vars.size(); pos++)
+            lits.at(pos) = ((mask >> pos) & 1) ? !vars.at(pos) : vars.at(pos);
+        add_clause_lits(lits);
+    }
+    return y;
+}
+
+template <typename V>
+V make_parity(std::vector<V> ops, bool negated)
+{
+    // Fold constants and cancel pairs of (possibly complemented) operands
+    std::vector<V> odd_ops;
+    odd_ops.reserve(ops.size());
+    for (const V& op : ops)
+    {
+        if (op == V::ONE) { negated = !negated; continue; }
+        if (op == V::ZERO) continue;
+
+        auto it = odd_ops.begin();
+        for (; it != odd_ops.end(); it++)
+        {
+            if (*it == op) break;
+            if (*it == !op) { negated = !negated; break; }
+        }
+        if (it != odd_ops.end()) odd_ops.erase(it);
+        else odd_ops.push_back(op);
+    }
+
+    if (odd_ops.empty()) return make_const<V>(negated);
+
+    // Cut the parity in blocks, the output of each block feeds the next ones
+    uint32_t next = 0;
+    while (odd_ops.size() - next > 1)
+    {
+        uint32_t width = std::min((uint32_t)XOR_CUT, (uint32_t)odd_ops.size() - next);
+        std::vector<V> block(odd_ops.begin() + next, odd_ops.begin() + next + width);
+        next += width;
+        odd_ops.push_back(make_parity_block(block));
+    }
+
+    const V& y = odd_ops.back();
+    return negated ? !y : y;
+}
+
+template var_t make_parity<var_t>(std::vector<var_t> ops, bool negated);
+template lit_t make_parity<lit_t>(std::vector<lit_t> ops, bool negated);
@@ -0,0 +1,73 @@
+/*
+ * -----------------------------------------------------------------------------
+ * AUTHORS : Vedad Hadžić, Graz University of Technology, Austria
+ *           Simon Tollec, Univ. Paris-Saclay, CEA-List, France
+ * DOCUMENT: https://eprint.iacr.org/2024/247
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright 2024, Commissariat à l'énergie atomique et aux énergies
+ * alternatives (CEA), France and Graz University of Technology, Austria
+ *
+ * Licensed under the Apache License, Version 2.0, see LICENSE for details.
+ *
+ */
+
+#ifndef VERIFIER_XOR_CHAINS_H
+#define VERIFIER_XOR_CHAINS_H
+
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Circuit.h"
+#include "vars.h"
+#include "Solver.h"
+
+using var_t = cxxsat::var_t;
+
+// Maximal number of inputs of a parity block encoded without auxiliary variable
+#define XOR_CUT 3
+// Maximal number of leaves of a row kept in the Gauss-Jordan basis
+#define XOR_MAX_ROW 64
+
+///////////   Xor_chain_t   ////////////////////////////////////////////////////
+// A maximal tree of XOR/XNOR gates whose inner gates only drive the tree:
+//  - the root equals the parity of `leaves` (pairs cancel out) xor `negated`
+//  - `inner` gates are not materialized, their bit-flips join the parity
+//  - `ops` is the Gauss-Jordan rewriting of the golden root in terms of
+//    leaves and roots computed before it
+
+struct xor_chain_t
+{
+    signal_id_t root;
+    bool negated;
+    std::vector<signal_id_t> leaves;
+    std::vector<signal_id_t> inner;
+    bool ops_negated;
+    std::vector<signal_id_t> ops;
+};
+
+struct xor_chains_t
+{
+    std::unordered_map<signal_id_t, xor_chain_t> roots;
+    std::unordered_set<signal_id_t> inner;
+    uint32_t rewritten = 0;
+};
+
+/*  Collapse XOR trees of the circuit and simplify the resulting parity system.
+ *  Signals in `kept_sigs` are always materialized (outputs, alerts, ...)
+ */
+xor_chains_t extract_xor_chains(const Circuit& circuit,
+                                const std::unordered_set<signal_id_t>& kept_sigs);
+
+std::stringstream xor_chains_info(const xor_chains_t& xor_chains);
+
+/*  Encode the parity of `ops` xor `negated`.
+ *  Constants and duplicated operands are simplified, long parities are cut in
+ *  blocks of `XOR_CUT` inputs encoded directly in CNF.
+ */
+template <typename V>
+V make_parity(std::vector<V> ops, bool negated);
+
+#endif // VERIFIER_XOR_CHAINS_H